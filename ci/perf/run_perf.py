@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2024 Antmicro
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+
+# Performance regression suite. For every Renode configuration from
+# ci/matrix.json it builds the firmware with BENCH=yes, feeds the corpora
+# from ci/perf/corpora through perf.robot, checks the encoder output against
+# a reference RLE encoder and records cycles, instructions, virtual time and
+# bytes moved per corpus. Results can be compared against a stored baseline,
+# and configurations built with different SYMBOL_WIDTH against each other.
+
+from argparse import ArgumentParser
+import json
+import os
+import re
+import subprocess
+import sys
+
+PERF_DIR = os.path.dirname(os.path.abspath(__file__))
+REPO_DIR = os.path.abspath(os.path.join(PERF_DIR, '..', '..'))
+PLATFORM = 'demo-renode'
+
+RESC = {
+    'none': 'vexriscv_rle.resc',
+    'dma': 'vexriscv_rle_dma.resc',
+    'axidma': 'vexriscv_rle_axidma.resc',
+    'hybrid': 'vexriscv_rle_hybrid.resc',
+}
+
+# Metrics compared against the baseline; a higher value is a regression
+METRICS = ['cycles', 'instructions', 'virtual_time_us', 'bytes_moved']
+
+RECORD_RE = re.compile(r'^\[(.), (\d+)\]( \(last\))?$')
+BENCH_RE = re.compile(r'^\[BENCH\] (\d+) symbols, (\d+) cycles'
+                      r'(?:, \d+ cycles/symbol, (\d+) bytes moved)?')
+TIME_RE = re.compile(r'(\d+):(\d+):(\d+)(?:\.(\d+))?')
+
+
+def reference_rle(data):
+    """Returns maximal (symbol, count) runs of `data`."""
+    runs = []
+    for sym in data:
+        if runs and runs[-1][0] == sym:
+            runs[-1][1] += 1
+        else:
+            runs.append([sym, 1])
+    return [tuple(r) for r in runs]
+
+
+def merge_runs(records):
+    """Merges adjacent records of the same symbol. The encoder may split a
+    run when its count saturates, which is still a correct encoding."""
+    return reference_rle(''.join(sym * count for sym, count in records))
+
+
+def config_name(config):
+    return '_'.join(kv.split('=')[1].lower() for kv in config.split())
+
+
+def config_dma(config):
+    return dict(kv.split('=') for kv in config.split())['DMA']
+
+
+def config_width(config):
+    return int(dict(kv.split('=') for kv in config.split())
+               .get('SYMBOL_WIDTH', 32))
+
+
+def build(config, out):
+    cmd = ['make', '-C', REPO_DIR, f'-j{os.cpu_count()}',
+           f'PLATFORM={PLATFORM}', f'OUT={out}', 'BENCH=yes'] + config.split()
+    subprocess.run(cmd, check=True)
+    return os.path.join(out, PLATFORM, f'fw_{PLATFORM}.elf')
+
+
+def run_renode(renode_test, binary, resc, corpus, raw, results_dir,
+               peripheral_config=None):
+    if os.path.exists(raw):
+        os.remove(raw)
+    cmd = [renode_test, os.path.join(PERF_DIR, 'perf.robot'),
+           '--results-dir', results_dir,
+           '--variable', f'BIN:{binary}',
+           '--variable', f'RESC:{os.path.join(REPO_DIR, resc)}',
+           '--variable', f'CORPUS:{corpus}',
+           '--variable', f'RAW_OUTPUT:{raw}']
+    if peripheral_config:
+        cmd += ['--variable', f'PERIPHERAL_CONFIG:{peripheral_config}']
+    subprocess.run(cmd, check=True)
+
+
+def parse_time_us(line):
+    m = TIME_RE.search(line)
+    if m is None:
+        return None
+    h, mins, s, frac = m.groups()
+    frac = (frac or '0')[:6].ljust(6, '0')
+    return ((int(h) * 60 + int(mins)) * 60 + int(s)) * 1000000 + int(frac)
+
+
+def parse_int(value):
+    try:
+        return int(value.strip(), 0)
+    except ValueError:
+        return None
+
+
+def parse_raw(raw):
+    requests = []
+    with open(raw, 'r') as f:
+        for line in f:
+            tag, _, value = line.rstrip('\n').partition('\t')
+            if tag == 'REQUEST':
+                requests.append({'input': value, 'out': [], 'metrics': {}})
+            elif tag == 'OUT':
+                requests[-1]['out'].append(value)
+            elif tag.endswith('_INSNS'):
+                requests[-1]['metrics'][tag] = parse_int(value)
+            elif tag.endswith('_TIME'):
+                requests[-1]['metrics'][tag] = parse_time_us(value)
+    return requests
+
+
+def delta(metrics, name):
+    begin, end = metrics.get(f'BEGIN_{name}'), metrics.get(f'END_{name}')
+    if begin is None or end is None:
+        return None
+    return end - begin
+
+
+def check_request(req):
+    records = []
+    cycles = None
+    bytes_moved = None
+    for line in req['out']:
+        m = RECORD_RE.match(line)
+        if m:
+            records.append((m.group(1), int(m.group(2))))
+            continue
+        m = BENCH_RE.match(line)
+        if m:
+            cycles = int(m.group(2))
+            if m.group(3) is not None:
+                bytes_moved = int(m.group(3))
+
+    expected = reference_rle(req['input'])
+    return {
+        'input': req['input'],
+        'ok': merge_runs(records) == expected,
+        'records': len(records),
+        'runs': len(expected),
+        'cycles': cycles,
+        'instructions': delta(req['metrics'], 'INSNS'),
+        'virtual_time_us': delta(req['metrics'], 'TIME'),
+        'bytes_moved': bytes_moved,
+    }
+
+
+def summarize(requests):
+    summary = {'ok': all(r['ok'] for r in requests),
+               'requests': len(requests),
+               'symbols': sum(len(r['input']) for r in requests)}
+    for metric in METRICS:
+        values = [r[metric] for r in requests]
+        summary[metric] = None if None in values else sum(values)
+    return summary
+
+
+def print_per_symbol(results):
+    """Prints the cost of a symbol in every configuration, which is what
+    builds with different symbol widths are compared on."""
+    for config, corpora in results.items():
+        for corpus, res in corpora.items():
+            summary = res['summary']
+            symbols = summary['symbols']
+            if not symbols:
+                continue
+            costs = [f'{config_width(config)}-bit symbols']
+            for metric, unit in (('cycles', 'cycles'),
+                                 ('bytes_moved', 'bytes')):
+                if summary[metric] is not None:
+                    costs.append(f'{summary[metric] / symbols:.2f} '
+                                 f'{unit}/symbol')
+            print(f'[PERF] {config}/{corpus}: {", ".join(costs)}')
+
+
+def compare(results, baseline, threshold):
+    regressions = []
+    for config, corpora in results.items():
+        for corpus, res in corpora.items():
+            base = baseline.get(config, {}).get(corpus)
+            if base is None:
+                print(f'[PERF] {config}/{corpus}: no baseline')
+                continue
+            for metric in METRICS:
+                new, old = res['summary'][metric], base['summary'][metric]
+                if new is None or not old:
+                    continue
+                change = (new - old) * 100.0 / old
+                status = 'REGRESSION' if change > threshold else 'ok'
+                print(f'[PERF] {config}/{corpus} {metric}: {old} -> {new} '
+                      f'({change:+.2f}%) {status}')
+                if change > threshold:
+                    regressions.append((config, corpus, metric))
+    return regressions
+
+
+def main():
+    parser = ArgumentParser()
+    parser.add_argument('--renode-test', type=str, default='renode-test',
+                        help='Path to the renode-test runner')
+    parser.add_argument('--matrix', type=str,
+                        default=os.path.join(REPO_DIR, 'ci', 'matrix.json'))
+    parser.add_argument('--corpora', type=str, nargs='*',
+                        help='Corpus files, one request per line')
+    parser.add_argument('--config', type=str, action='append',
+                        help='Run only the given make config (repeatable)')
+    parser.add_argument('--work-dir', type=str,
+                        default=os.path.join(REPO_DIR, 'out', 'perf'))
+    parser.add_argument('--output', type=str,
+                        default=os.path.join(REPO_DIR, 'out', 'perf',
+                                             'results.json'))
+    parser.add_argument('--baseline', type=str,
+                        help='Results file to compare against')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='Allowed increase of any metric, in percent')
+    parser.add_argument('--peripheral-config', type=str, action='append',
+                        default=[], metavar='WIDTH=PATH',
+                        help='Peripheral config of the encoder built for '
+                             'SYMBOL_WIDTH=WIDTH (repeatable)')
+    args = parser.parse_args()
+
+    peripheral_configs = {}
+    for arg in args.peripheral_config:
+        width, sep, path = arg.partition('=')
+        if not sep or not width.isdigit():
+            parser.error(f'--peripheral-config expects WIDTH=PATH, '
+                         f'got "{arg}"')
+        peripheral_configs[int(width)] = os.path.abspath(path)
+
+    with open(args.matrix, 'r') as f:
+        configs = args.config or json.loads(f.read())['config']
+    for config in configs:
+        width = config_width(config)
+        if width != 32 and width not in peripheral_configs:
+            parser.error(f'"{config}" needs --peripheral-config {width}=PATH')
+    corpora = args.corpora or sorted(
+        os.path.join(PERF_DIR, 'corpora', c)
+        for c in os.listdir(os.path.join(PERF_DIR, 'corpora')))
+
+    results = {}
+    for config in configs:
+        name = config_name(config)
+        work = os.path.join(args.work_dir, name)
+        binary = build(config, os.path.join(work, 'out'))
+        results[config] = {}
+        for corpus in corpora:
+            corpus_name = os.path.splitext(os.path.basename(corpus))[0]
+            raw = os.path.join(work, f'{corpus_name}.raw')
+            run_renode(args.renode_test, binary, RESC[config_dma(config)],
+                       corpus, raw, os.path.join(work, 'robot', corpus_name),
+                       peripheral_configs.get(config_width(config)))
+            requests = [check_request(r) for r in parse_raw(raw)]
+            results[config][corpus_name] = {
+                'summary': summarize(requests),
+                'requests': requests,
+            }
+            for r in requests:
+                if not r['ok']:
+                    print(f'[PERF] {name}/{corpus_name}: wrong output for '
+                          f'"{r["input"]}"')
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2)
+
+    print_per_symbol(results)
+
+    failed = any(not c['summary']['ok']
+                 for corpora in results.values() for c in corpora.values())
+
+    regressions = []
+    if args.baseline:
+        with open(args.baseline, 'r') as f:
+            regressions = compare(results, json.loads(f.read()),
+                                  args.threshold)
+
+    if failed or regressions:
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -1,8 +1,78 @@
 PLATFORM ?= demo-renode
-# Allowed options: none, dma, axidma
+# Allowed options: none, dma, axidma, hybrid
 DMA ?= none
 # Allowed options: yes, no
 INTERRUPTS ?= no
+# With INTERRUPTS=yes, raise the DMA completion interrupt only on every n-th
+# chunk of a request and on its last chunk
+IRQ_COALESCE ?= 1
+# Claim a single PLIC interrupt per trap instead of claiming until none are
+# pending (u54-mc only)
+# Allowed options: loop, single
+IRQ_CLAIM ?= loop
+# Receive the encoder output into a ring of DMA slots that stays armed for the
+# whole request, consuming slots as they fill (not available with DMA=none,
+# PIPELINE=yes, BATCH=yes or ROUNDTRIP=yes)
+# Allowed options: yes, no
+RX_RING ?= no
+# Largest DMA chunk in symbols and number of DMA staging buffers of that size
+DMA_CHUNK_MAX ?= 256
+DMA_POOL_BLOCKS ?= 4
+# Measure the cost of DMA chunk sizes up to DMA_CHUNK_MAX on startup and use
+# the cheapest one (not available with DMA=none, PIPELINE=yes, BATCH=yes or
+# ROUNDTRIP=yes)
+# Allowed options: yes, no
+AUTOTUNE ?= no
+# Symbol width in bits, must match the encoder design
+# Allowed options: 8, 16, 32
+SYMBOL_WIDTH ?= 32
+# Merge encoder records into wide-count runs before printing them
+# Allowed options: yes, no
+COALESCE ?= no
+# Run UART input, encoding and output as a pipeline of cooperative tasks
+# Allowed options: yes, no
+PIPELINE ?= no
+# Encode several requests from one input line with a single pair of DMA
+# transfers (DMA=dma only)
+# Allowed options: yes, no
+BATCH ?= no
+# Decode the encoder output with a second XLS block and compare it with the
+# input (not available with DMA=hybrid, PIPELINE=yes or BATCH=yes)
+# Allowed options: yes, no
+ROUNDTRIP ?= no
+# Encode the corpus loaded into RAM at CORPUS_ADDR on startup and on
+# "/corpus", printing only a summary (not available with PIPELINE=yes,
+# BATCH=yes or ROUNDTRIP=yes)
+# Allowed options: yes, no
+CORPUS ?= no
+# Where the encoder output goes: printed over the UART, stored in a memory
+# sink with a running CRC-32, or only folded into the CRC-32 (not available
+# with PIPELINE=yes, BATCH=yes or ROUNDTRIP=yes)
+# Allowed options: print, memory, discard
+SINK ?= print
+# Compute CRC-32 with carry-less multiply instructions (the core must
+# implement Zbc)
+# Allowed options: yes, no
+CLMUL ?= no
+# Keep per-transport latency histograms of requests by input size, printed
+# with "/lat" (not available with PIPELINE=yes, BATCH=yes or ROUNDTRIP=yes)
+# Allowed options: yes, no
+LATENCY ?= no
+# Record DMA, interrupt and stream events in an in-memory trace
+# Allowed options: yes, no
+TRACE ?= no
+# Run the trap entry, ISR, driver hot paths and DMA buffers from on-chip SRAM
+# Allowed options: yes, no
+FAST_MEM ?= no
+# Print cycle counts for each request
+# Allowed options: yes, no
+BENCH ?= no
+# Count register accesses per call site, register and device
+# Allowed options: yes, no
+MMIO_STATS ?= no
+# Mark encode phases and DMA transfers with gem5 m5ops (demo-gem5 only)
+# Allowed options: yes, no
+M5OPS ?= no
 
 OUT ?= out
 
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2024 Antmicro
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Builds an input corpus for the firmware's corpus mode (CORPUS=yes): a 16-byte
+# header (magic "RLEC", data length, CRC-32 of the data, reserved) followed by
+# the data. The data is either the concatenation of the given files or
+# synthetic, e.g.:
+#
+#   scripts/mkcorpus.py -o corpus.bin --kind runs --size 4MiB
+#   scripts/mkcorpus.py -o corpus.bin /usr/share/dict/words
+
+import argparse
+import random
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = b'RLEC'
+HEADER = struct.Struct('<4sIII')
+
+
+def parse_size(text):
+    m = re.fullmatch(r'(\d+)\s*(|k|KiB|M|MiB)', text)
+    if not m:
+        raise argparse.ArgumentTypeError(f'invalid size: {text}')
+    mult = {'': 1, 'k': 1024, 'KiB': 1024, 'M': 1 << 20, 'MiB': 1 << 20}
+    return int(m.group(1)) * mult[m.group(2)]
+
+
+def gen_runs(size, rng):
+    """Runs of 1-16 repeated letters, the encoder's favourable case"""
+    out = bytearray()
+    while len(out) < size:
+        out += bytes([rng.randrange(ord('a'), ord('z') + 1)]) * \
+            rng.randint(1, 16)
+    return bytes(out[:size])
+
+
+def gen_random(size, rng):
+    """Letters without any structure, mostly runs of one"""
+    return bytes(rng.randrange(ord('a'), ord('z') + 1) for _ in range(size))
+
+
+def gen_text(size, rng):
+    """Words separated with spaces, close to the interactive inputs"""
+    words = [b'lorem', b'ipsum', b'dolor', b'sit', b'amet', b'aaaa', b'zzz',
+             b'bookkeeper', b'mississippi', b'committee']
+    out = bytearray()
+    while len(out) < size:
+        out += rng.choice(words) + b' '
+    return bytes(out[:size])
+
+
+GENERATORS = {'runs': gen_runs, 'random': gen_random, 'text': gen_text}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('inputs', nargs='*', help='Files to concatenate')
+    parser.add_argument('-o', '--output', required=True)
+    parser.add_argument('--kind', choices=GENERATORS.keys(),
+                        help='Generate synthetic data instead')
+    parser.add_argument('--size', type=parse_size, default=parse_size('1MiB'),
+                        help='Size of the synthetic data (default 1MiB)')
+    parser.add_argument('--seed', type=int, default=0)
+    parser.add_argument('--max-size', type=parse_size,
+                        default=0x07000000 - HEADER.size,
+                        help='Corpus memory size minus the header '
+                             '(CORPUS_SIZE in the platform config.mk)')
+    args = parser.parse_args()
+
+    if bool(args.inputs) == bool(args.kind):
+        parser.error('give either input files or --kind')
+
+    if args.kind:
+        data = GENERATORS[args.kind](args.size, random.Random(args.seed))
+    else:
+        data = b''.join(open(path, 'rb').read() for path in args.inputs)
+
+    if len(data) > args.max_size:
+        sys.exit(f'corpus too large: {len(data)} > {args.max_size} bytes')
+
+    with open(args.output, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, len(data), zlib.crc32(data), 0))
+        f.write(data)
+    print(f'{args.output}: {len(data)} bytes, crc32 {zlib.crc32(data):08x}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2024 Antmicro
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+# Converts a binary trace dumped by the firmware (`/trace` command) into
+# the Chrome trace event format, which can be opened in Perfetto UI or
+# chrome://tracing. The input may be a raw UART capture; everything before
+# the "XTRC" magic is skipped.
+
+from argparse import ArgumentParser
+import json
+import struct
+
+MAGIC = b'XTRC'
+HEADER = struct.Struct('<II')
+RECORD = struct.Struct('<IBBH')
+
+# Must match `trace_event_t` in src/common/trace.h
+TSFR_BEGIN = 1
+TSFR_COMPLETE = 2
+TSFR_CANCEL = 3
+ISR_ENTER = 4
+ISR_EXIT = 5
+STREAM_WAIT_BEGIN = 6
+STREAM_WAIT_END = 7
+CALLBACK_BEGIN = 8
+CALLBACK_END = 9
+
+CHAN_NONE = 0xff
+
+# Perfetto "threads" the events are grouped into
+TID_CPU = 0
+TID_ISR = 1
+TID_DMA_BASE = 100
+
+
+def read_records(data):
+    start = data.find(MAGIC)
+    if start < 0:
+        raise RuntimeError('No trace found in the input')
+    offset = start + len(MAGIC)
+    total, count = HEADER.unpack_from(data, offset)
+    offset += HEADER.size
+    if len(data) < offset + count * RECORD.size:
+        raise RuntimeError('Trace is truncated')
+
+    records = [RECORD.unpack_from(data, offset + i * RECORD.size)
+               for i in range(count)]
+    return total, records
+
+
+def unwrap_cycles(records):
+    """Extends 32-bit mcycle stamps, assuming less than 2^32 cycles pass
+    between consecutive events."""
+    wraps = 0
+    prev = None
+    for cycle, event, chan, arg in records:
+        if prev is not None and cycle < prev and prev - cycle > (1 << 31):
+            wraps += 1
+        prev = cycle
+        yield (wraps << 32) + cycle, event, chan, arg
+
+
+def convert(records, cpu_freq_hz):
+    events = []
+    us_per_cycle = 1e6 / cpu_freq_hz
+
+    def add(ph, name, tid, ts, **extra):
+        ev = {'ph': ph, 'name': name, 'pid': 0, 'tid': tid,
+              'ts': ts * us_per_cycle}
+        ev.update(extra)
+        events.append(ev)
+
+    for cycle, event, chan, arg in unwrap_cycles(records):
+        if event == TSFR_BEGIN:
+            add('B', f'transfer ch{chan}', TID_DMA_BASE + chan, cycle,
+                args={'len': arg})
+        elif event == TSFR_COMPLETE:
+            add('E', f'transfer ch{chan}', TID_DMA_BASE + chan, cycle,
+                args={'transferred': arg})
+        elif event == TSFR_CANCEL:
+            add('E', f'transfer ch{chan}', TID_DMA_BASE + chan, cycle,
+                args={'cancelled': True})
+        elif event == ISR_ENTER:
+            add('B', 'isr', TID_ISR, cycle, args={'irq': arg})
+        elif event == ISR_EXIT:
+            add('E', 'isr', TID_ISR, cycle)
+        elif event == STREAM_WAIT_BEGIN:
+            add('B', f'stream {chan} RDY wait', TID_CPU, cycle)
+        elif event == STREAM_WAIT_END:
+            add('E', f'stream {chan} RDY wait', TID_CPU, cycle)
+        elif event == CALLBACK_BEGIN:
+            add('B', f'callback ch{chan}', TID_CPU, cycle)
+        elif event == CALLBACK_END:
+            add('E', f'callback ch{chan}', TID_CPU, cycle)
+        else:
+            add('i', f'unknown event {event}', TID_CPU, cycle, s='t')
+
+    names = {TID_CPU: 'cpu', TID_ISR: 'isr'}
+    for tid in sorted({ev['tid'] for ev in events}):
+        name = names.get(tid, f'dma ch{tid - TID_DMA_BASE}')
+        events.append({'ph': 'M', 'name': 'thread_name', 'pid': 0,
+                       'tid': tid, 'args': {'name': name}})
+    return events
+
+
+def main():
+    parser = ArgumentParser()
+    parser.add_argument('input', type=str, help='Binary UART capture')
+    parser.add_argument('output', type=str, help='Output JSON file')
+    parser.add_argument('--cpu-freq-hz', type=float, default=100e6,
+                        help='Frequency used to convert cycles to time')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        total, records = read_records(f.read())
+
+    if total > len(records):
+        print(f'Note: {total - len(records)} oldest events were overwritten')
+
+    with open(args.output, 'w') as f:
+        json.dump({'traceEvents': convert(records, args.cpu_freq_hz),
+                   'displayTimeUnit': 'ns'}, f)
+
+
+if __name__ == '__main__':
+    main()
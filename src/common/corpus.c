@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "corpus.h"
+
+#include "crc32.h"
+
+int corpus_open(uintptr_t addr, size_t size, const corpus_hdr_t** hdr) {
+  const corpus_hdr_t* h = (const corpus_hdr_t*)addr;
+
+  if (h->ch_magic != CORPUS_MAGIC) return CORPUS_BAD_MAGIC;
+  if (h->ch_len > size - sizeof(*h)) return CORPUS_TOO_LONG;
+  if (crc32_update(0, corpus_data(h), h->ch_len) != h->ch_crc32)
+    return CORPUS_BAD_CRC;
+
+  *hdr = h;
+  return CORPUS_OK;
+}
+
+const char* corpus_err_name(int code) {
+  switch (code) {
+    case CORPUS_OK:
+      return "OK";
+    case CORPUS_BAD_MAGIC:
+      return "BAD_MAGIC";
+    case CORPUS_TOO_LONG:
+      return "TOO_LONG";
+    case CORPUS_BAD_CRC:
+      return "BAD_CRC";
+  }
+  return "[UNKNOWN]";
+}
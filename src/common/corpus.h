@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_CORPUS_H_
+#define COMMON_CORPUS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Memory-resident input corpus.
+ *
+ * The corpus is placed in RAM by the simulator (Renode `sysbus LoadBinary`,
+ * gem5 memory image) at CORPUS_ADDR, so that the encoder can be fed at memory
+ * speed instead of UART speed. It starts with a header, followed by `ch_len`
+ * bytes of data. `ch_crc32` is the CRC-32 of the data. Corpora are built with
+ * scripts/mkcorpus.py. */
+
+/* "RLEC" */
+#define CORPUS_MAGIC 0x43454c52
+
+// clang-format off
+#define CORPUS_OK                  0
+#define CORPUS_BAD_MAGIC           1
+#define CORPUS_TOO_LONG            2
+#define CORPUS_BAD_CRC             3
+// clang-format on
+
+typedef struct corpus_hdr {
+  uint32_t ch_magic;
+  uint32_t ch_len;
+  uint32_t ch_crc32;
+  uint32_t ch_reserved;
+} corpus_hdr_t;
+
+/* Validates the header at `addr` and the checksum of the data. `size` is the
+ * size of the memory reserved for the corpus, header included. */
+int corpus_open(uintptr_t addr, size_t size, const corpus_hdr_t** hdr);
+
+static inline const char* corpus_data(const corpus_hdr_t* hdr) {
+  return (const char*)(hdr + 1);
+}
+
+const char* corpus_err_name(int code);
+
+#endif /* COMMON_CORPUS_H_ */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crc32.h"
+
+#if defined(__riscv_zbc) || defined(__riscv_zbkc)
+#define CRC32_CLMUL
+#endif
+
+#ifdef CRC32_CLMUL
+
+static inline uint32_t clmul(uint32_t a, uint32_t b) {
+  uint32_t r;
+  asm("clmul %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+  return r;
+}
+
+static inline uint32_t clmulh(uint32_t a, uint32_t b) {
+  uint32_t r;
+  asm("clmulh %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+  return r;
+}
+
+/* Advances the CRC register `a` by 32 bits of zeros, i.e. multiplies it by
+ * x^32 modulo the polynomial, with Barrett reduction. Both constants are
+ * reflected and have an implicit x^32 term:
+ * mu = x^64 / P = 0x1f7011641, P = 0x1db710641. */
+static inline uint32_t crc32_fold(uint32_t a) {
+  uint32_t q = clmul(a, 0xf7011641);
+  return clmulh(q, 0xdb710641) ^ q;
+}
+
+static inline uint32_t crc32_byte(uint32_t crc, uint8_t b) {
+  return (crc >> 8) ^ crc32_fold((crc ^ b) << 24);
+}
+
+static inline uint32_t crc32_word(uint32_t crc, uint32_t w) {
+  return crc32_fold(crc ^ w);
+}
+
+const char* crc32_impl(void) { return "clmul"; }
+
+#else /* CRC32_CLMUL */
+
+#define CRC32_POLY 0xedb88320u
+
+/* crc32_table[0] is the byte-wise table. crc32_table[k][i] is the CRC of
+ * byte i followed by k zero bytes. */
+static uint32_t crc32_table[4][256];
+static int crc32_table_ready;
+
+static void crc32_init_table(void) {
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int j = 0; j < 8; ++j) {
+      crc = (crc >> 1) ^ (CRC32_POLY & -(crc & 1));
+    }
+    crc32_table[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (int k = 1; k < 4; ++k) {
+      uint32_t prev     = crc32_table[k - 1][i];
+      crc32_table[k][i] = (prev >> 8) ^ crc32_table[0][prev & 0xff];
+    }
+  }
+  crc32_table_ready = 1;
+}
+
+static inline uint32_t crc32_byte(uint32_t crc, uint8_t b) {
+  return (crc >> 8) ^ crc32_table[0][(crc ^ b) & 0xff];
+}
+
+static inline uint32_t crc32_word(uint32_t crc, uint32_t w) {
+  crc ^= w;
+  return crc32_table[3][crc & 0xff] ^ crc32_table[2][(crc >> 8) & 0xff] ^
+         crc32_table[1][(crc >> 16) & 0xff] ^ crc32_table[0][crc >> 24];
+}
+
+const char* crc32_impl(void) { return "slice-by-4"; }
+
+#endif /* CRC32_CLMUL */
+
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len) {
+  const uint8_t* p = data;
+
+#ifndef CRC32_CLMUL
+  if (!crc32_table_ready) crc32_init_table();
+#endif
+
+  crc = ~crc;
+  for (; len && ((uintptr_t)p & 3); --len) {
+    crc = crc32_byte(crc, *p++);
+  }
+  for (; len >= 4; len -= 4, p += 4) {
+    crc = crc32_word(crc, *(const uint32_t*)p);
+  }
+  for (; len; --len) {
+    crc = crc32_byte(crc, *p++);
+  }
+  return ~crc;
+}
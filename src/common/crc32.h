@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_CRC32_H_
+#define COMMON_CRC32_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CRC-32 (IEEE 802.3, reflected, as in zlib). Start with `crc` = 0 and pass
+ * the result of the previous call to continue a running checksum.
+ *
+ * Whole 32-bit words are folded with carry-less multiplication if the target
+ * has Zbc or Zbkc (`-march=..._zbc`), and with slice-by-4 lookup tables
+ * otherwise. The tables (4 KiB) are built on first use. */
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len);
+
+/* Name of the implementation, for reports */
+const char* crc32_impl(void);
+
+#endif /* COMMON_CRC32_H_ */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "fmt.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+void fmt_str(fmt_buf_t* fmt, const char* str) {
+  while (*str && fmt->f_len < fmt->f_cap) {
+    fmt->f_buf[fmt->f_len++] = *str++;
+  }
+}
+
+void fmt_udec(fmt_buf_t* fmt, uint32_t val) {
+  char digits[10];
+  int cnt = 0;
+  do {
+    digits[cnt++] = '0' + val % 10;
+    val /= 10;
+  } while (val);
+  while (cnt) {
+    fmt_char(fmt, digits[--cnt]);
+  }
+}
+
+void fmt_hex(fmt_buf_t* fmt, uint32_t val, unsigned digits) {
+  static const char hex[] = "0123456789abcdef";
+  fmt_char(fmt, '0');
+  fmt_char(fmt, 'x');
+  for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+    fmt_char(fmt, hex[(val >> shift) & 0xf]);
+  }
+}
+
+void fmt_flush(fmt_buf_t* fmt) {
+  if (!fmt->f_len) return;
+  /* Keep the order with diagnostics still buffered by stdio */
+  fflush(stdout);
+  write(STDOUT_FILENO, fmt->f_buf, fmt->f_len);
+  fmt->f_len = 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_FMT_H_
+#define COMMON_FMT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fixed-function formatter for the output path.
+ *
+ * Formats characters, strings and integers into a caller-provided buffer
+ * without format string parsing or varargs, and writes the whole buffer with
+ * a single `write` call on flush. Output that doesn't fit into the buffer is
+ * dropped, so callers should check `fmt_space` (or flush) before formatting
+ * a record. newlib `printf` is meant for diagnostics only. */
+
+typedef struct fmt_buf {
+  char* f_buf;
+  size_t f_cap;
+  size_t f_len;
+} fmt_buf_t;
+
+static inline void fmt_init(fmt_buf_t* fmt, char* buf, size_t cap) {
+  fmt->f_buf = buf;
+  fmt->f_cap = cap;
+  fmt->f_len = 0;
+}
+
+static inline size_t fmt_space(const fmt_buf_t* fmt) {
+  return fmt->f_cap - fmt->f_len;
+}
+
+static inline void fmt_char(fmt_buf_t* fmt, char c) {
+  if (fmt->f_len < fmt->f_cap) {
+    fmt->f_buf[fmt->f_len++] = c;
+  }
+}
+
+void fmt_str(fmt_buf_t* fmt, const char* str);
+
+/* Unsigned decimal */
+void fmt_udec(fmt_buf_t* fmt, uint32_t val);
+
+/* Lowercase hexadecimal with a "0x" prefix, zero-padded to `digits`
+ * (1 to 8) */
+void fmt_hex(fmt_buf_t* fmt, uint32_t val, unsigned digits);
+
+/* Writes the buffered text to stdout and empties the buffer */
+void fmt_flush(fmt_buf_t* fmt);
+
+#endif /* COMMON_FMT_H_ */
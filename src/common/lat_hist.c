@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "lat_hist.h"
+
+#include <string.h>
+
+#define SUB_BUCKETS (1u << LAT_HIST_SUB_BITS)
+
+static uint32_t bucket_idx(uint32_t value) {
+  if (value < SUB_BUCKETS) return value;
+  uint32_t shift = 31 - __builtin_clz(value) - LAT_HIST_SUB_BITS;
+  return ((shift + 1) << LAT_HIST_SUB_BITS) |
+         ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+/* Highest value that falls into bucket `idx` */
+static uint32_t bucket_max(uint32_t idx) {
+  if (idx < SUB_BUCKETS) return idx;
+  uint32_t shift = (idx >> LAT_HIST_SUB_BITS) - 1;
+  uint32_t low   = ((idx & (SUB_BUCKETS - 1)) | SUB_BUCKETS) << shift;
+  return low + ((1u << shift) - 1);
+}
+
+void lat_hist_reset(lat_hist_t* hist) {
+  memset(hist, 0, sizeof(*hist));
+  hist->lh_min = UINT32_MAX;
+}
+
+void lat_hist_record(lat_hist_t* hist, uint32_t value) {
+  ++hist->lh_buckets[bucket_idx(value)];
+  ++hist->lh_count;
+  hist->lh_sum += value;
+  if (value < hist->lh_min) hist->lh_min = value;
+  if (value > hist->lh_max) hist->lh_max = value;
+}
+
+uint32_t lat_hist_percentile(const lat_hist_t* hist, uint32_t permille) {
+  if (hist->lh_count == 0) return 0;
+
+  /* Rank of the value, rounded up, at least 1 */
+  uint32_t rank =
+      (uint32_t)(((uint64_t)hist->lh_count * permille + 999) / 1000);
+  if (rank == 0) rank = 1;
+
+  uint32_t seen = 0;
+  for (uint32_t i = 0; i < LAT_HIST_BUCKETS; ++i) {
+    seen += hist->lh_buckets[i];
+    if (seen >= rank) {
+      uint32_t value = bucket_max(i);
+      return value < hist->lh_max ? value : hist->lh_max;
+    }
+  }
+  return hist->lh_max;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_LAT_HIST_H_
+#define COMMON_LAT_HIST_H_
+
+#include <stdint.h>
+
+/* Log-bucketed latency histogram.
+ *
+ * Values are recorded into buckets whose width grows with the magnitude of
+ * the value, like in HdrHistogram: every power of two is split into
+ * 2^LAT_HIST_SUB_BITS equal buckets, so a percentile is reported with
+ * a relative error below 2^-LAT_HIST_SUB_BITS over the whole 32-bit range,
+ * while the histogram takes a constant LAT_HIST_BUCKETS counters. Values
+ * below 2^LAT_HIST_SUB_BITS are counted exactly. */
+
+#define LAT_HIST_SUB_BITS 3
+#define LAT_HIST_BUCKETS ((32 - LAT_HIST_SUB_BITS + 1) << LAT_HIST_SUB_BITS)
+
+typedef struct lat_hist {
+  uint32_t lh_count;
+  uint32_t lh_min;
+  uint32_t lh_max;
+  uint64_t lh_sum;
+  uint32_t lh_buckets[LAT_HIST_BUCKETS];
+} lat_hist_t;
+
+void lat_hist_reset(lat_hist_t* hist);
+
+void lat_hist_record(lat_hist_t* hist, uint32_t value);
+
+/* Returns the highest value equivalent to the one below which `permille`
+ * thousandths of the recorded values fall (clamped to the largest recorded
+ * value), or 0 if the histogram is empty */
+uint32_t lat_hist_percentile(const lat_hist_t* hist, uint32_t permille);
+
+#endif /* COMMON_LAT_HIST_H_ */
@@ -20,213 +20,57 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "common/corpus.h"
+#include "common/crc32.h"
+#include "common/fmt.h"
+#include "common/mmio.h"
+#include "common/perf_region.h"
+#include "common/rle_batch.h"
+#include "common/rle_coalesce.h"
+#include "common/rle_hybrid.h"
+#include "common/rle_irq_bench.h"
+#include "common/rle_latency.h"
+#include "common/rle_link.h"
+#include "common/rle_pipeline.h"
+#include "common/rle_print.h"
+#include "common/rle_roundtrip.h"
+#include "common/rle_sink.h"
+#include "common/rle_tune.h"
+#include "common/sections.h"
+#include "common/trace.h"
 #include "cpu/interrupts.h"
 #include "cpu/riscv_csr.h"
 #include "dev/rle.h"
+#ifdef RLE_ROUNDTRIP
+#include "dev/rle_dec.h"
+#endif
 #include "xls/xls_dma.h"
-#include "xls/xls_stream.h"
-
-typedef void (*on_encoded_t)(void*, rle_enc_out_data_t);
+#include "xls/xls_dma_pool.h"
 
-static const size_t RLE_TIMEOUT_CYCLES = 10000;
+#define QUOTE(A) #A
+#define CAT3(A, B, C) #A QUOTE(B) #C
+#define FMT_INPUT_BUF CAT3(%, INPUT_BUF_STRLEN, s)
 
 #ifdef RLE_DMA_IRQ
-void isr(uint32_t irq) {
+FAST_TEXT void isr(uint32_t irq) {
+#ifndef TRACE_ENABLED
+  /* ISR entry and exit are recorded in the trace instead */
   printf("Interrupt handler, irq: %ld\n", irq);
+#endif
 
   if (irq == RLE_DMA_IRQ_NUM) {
     xls_dma_update_isr(rle0_dma, &rle0_dma_man);
   }
-}
-#else
-void isr(uint32_t irq) {}
-#endif
-
-
-#ifndef RLE_DMA
-
-static void run_text_rle(const char* data, void* ctx, on_encoded_t callback) {
-  while (*data != '\0') {
-    int last;
-    do {
-      last                              = data[1] == '\0';
-      rle0_io.io_input_r->s_data.e_sym  = (rle_sym_t)*data;
-      rle0_io.io_input_r->s_data.e_last = last;
-      xls_poll_and_transfer(&rle0_io.io_input_r->s_stream);
-      ++data;
-    } while (!last && xls_is_ready(&rle0_io.io_input_r->s_stream));
-    do {
-      xls_poll_and_transfer(&rle0_io.io_output_s->s_stream);
-      callback(ctx, rle0_io.io_output_s->s_data);
-    } while (xls_is_ready(&rle0_io.io_output_s->s_stream));
+#ifdef RLE_ROUNDTRIP
+  if (irq == RLE_DEC_DMA_IRQ_NUM) {
+    xls_dma_update_isr(rle_dec0_dma, &rle_dec0_dma_man);
   }
-
-  /* There might be some data left */
-  for (size_t i = 0; i < RLE_TIMEOUT_CYCLES; ++i) {
-    if (xls_is_ready((xls_stream_t*)rle0_io.io_output_s)) {
-      xls_poll_and_transfer((xls_stream_t*)rle0_io.io_output_s);
-      callback(ctx, rle0_io.io_output_s->s_data);
-      i = 0;
-    }
-  }
-}
-
-#endif /* RLE_DMA */
-
-#ifdef RLE_DMA
-
-#define DMATSFR_BUF_LEN 256
-static rle_enc_in_data_t dma_tsfr_in_buf[DMATSFR_BUF_LEN];
-static rle_enc_out_data_t dma_tsfr_out_buf[DMATSFR_BUF_LEN];
-
-#define MIN(a, b) (((a) <= (b)) ? (a) : (b))
-
-static void print_tsfr_error(int code) {
-  if (code == XLS_DMA_OK) {
-    printf("DMA procedure succeded\n");
-    return;
-  }
-  printf("DMA procedure failed with code %s", xls_dma_err_name(code));
-}
-
-typedef void (*on_encoded_dma_t)(void*, rle_sym_t* data);
-
-static void prepare_dma_input_buf(char* data, size_t count) {
-  for (size_t i = 0; i < count; i++) {
-    dma_tsfr_in_buf[i].e_sym = data[i];
-#ifndef RLE_DMA_AXI
-    dma_tsfr_in_buf[i].e_last = (i == count - 1);
 #endif
-  }
-}
-
-#ifdef RLE_DMA
-void complete_transfer(xls_dma_tsfr_t* tsfr) {
-  uint32_t count = tsfr->tsfr_transferred_bytes;
-  const char* tsfr_name = (const char*)tsfr->tsfr_ctx;
-  printf("DMA transfer \"%s\" complete. Transferred %ld bytes\n",
-         tsfr_name, count);
-}
-#endif /* RLE_DMA */
-
-static int send_rle_input_dma(xls_dma_tsfr_t* tsfr) {
-  int err;
-  xls_dma_poll_ready(tsfr);
-  if ((err = xls_dma_begin_transfer(tsfr))) {
-    print_tsfr_error(err);
-    return err;
-  }
-  if ((err = xls_dma_complete_transfer(tsfr, 0))) {
-    print_tsfr_error(err);
-    return err;
-  }
-
-  return XLS_DMA_OK;
-}
-
-static int receive_rle_output_dma(xls_dma_tsfr_t* tsfr) {
-  int err;
-  xls_dma_poll_ready(tsfr);
-  if ((err = xls_dma_begin_transfer(tsfr))) {
-    print_tsfr_error(err);
-    return err;
-  }
-  if ((err = xls_dma_complete_transfer(tsfr, RLE_TIMEOUT_CYCLES))) {
-#ifdef RLE_DMA_AXI
-    print_tsfr_error(err);
-    return err;
-#else  /* RLE_DMA_AXI */
-    if (err != XLS_DMA_TIMEOUT) {
-      print_tsfr_error(err);
-      return err;
-    }
-    uint32_t count = tsfr->tsfr_transferred_bytes;
-    const char* tsfr_name = (const char*)tsfr->tsfr_ctx;
-    printf("DMA tranfer \"%s\" timed out. Transferred %ld bytes\n",
-           tsfr_name, count);
-    xls_dma_cancel_transfer(tsfr);
-#endif /* RLE_DMA_AXI */
-  }
-
-  return XLS_DMA_OK;
-}
-
-static void run_text_rle_dma(char* data, void* ctx, on_encoded_t callback) {
-  size_t remaining = strlen(data);
-  while (remaining) {
-    uint64_t tsfr_len = MIN(remaining, DMATSFR_BUF_LEN);
-
-    prepare_dma_input_buf(data, tsfr_len);
-
-    // clang-format off
-    xls_dma_tsfr_t input_transfer = {
-        .tsfr_dma          = rle0_dma,
-        .tsfr_chan         = RLE_RD_CHAN,
-        .tsfr_data         = dma_tsfr_in_buf,
-        .tsfr_len          = tsfr_len * sizeof(rle_enc_in_data_t),
-        .tsfr_ignore       = 0,
-        .tsfr_dir          = XLS_TSFR_TO_PERIPHERAL,
-        .tsfr_ctx          = "SIM->XLS",
-        .tsfr_callback_isr = &complete_transfer,
-#ifdef RLE_DMA_IRQ
-        .tsfr_dma_man      = &rle0_dma_man,
-        .tsfr_polling      = 0,
-#else  /* RLE_DMA_IRQ */
-        .tsfr_polling      = 1,
-#endif /* RLE_DMA_IRQ */
-    };
-    xls_dma_tsfr_t output_transfer = {
-        .tsfr_dma          = rle0_dma,
-        .tsfr_chan         = RLE_WR_CHAN,
-        .tsfr_data         = dma_tsfr_out_buf,
-        .tsfr_len          = tsfr_len * sizeof(rle_enc_out_data_t),
-        .tsfr_ignore       = 0,
-        .tsfr_dir          = XLS_TSFR_FROM_PERIPHERAL,
-        .tsfr_ctx          = "XLS->SIM",
-        .tsfr_callback_isr = &complete_transfer,
-#ifdef RLE_DMA_IRQ
-        .tsfr_dma_man      = &rle0_dma_man,
-        .tsfr_polling      = 0,
-#else  /* RLE_DMA_IRQ */
-        .tsfr_polling      = 1,
-#endif /* RLE_DMA_IRQ */
-    };
-    // clang-format on
-
-    if (send_rle_input_dma(&input_transfer)) {
-      return;
-    }
-    if (receive_rle_output_dma(&output_transfer)) {
-      return;
-    }
-
-#ifdef RLE_DMA_AXI
-    uint32_t output_elements_cnt =
-        output_transfer.tsfr_transferred_bytes / sizeof(rle_enc_out_data_t);
-    for (int i = 0; i < output_elements_cnt; ++i) {
-      callback(ctx, dma_tsfr_out_buf[i]);
-    }
-#else  /* RLE_DMA_AXI */
-    for (int i = 0; i < tsfr_len; i++) {
-      callback(ctx, dma_tsfr_out_buf[i]);
-      if (dma_tsfr_out_buf[i].e_last) break;
-    }
-#endif /* RLE_DMA_AXI */
-
-    remaining -= tsfr_len;
-  }
 }
+#else
+FAST_TEXT void isr(uint32_t irq) {}
 #endif
 
-static void print_encoded_sym(void* ctx, rle_enc_out_data_t sym) {
-#ifdef RLE_DMA_AXI
-  printf("[%c, %u]\n", (char)sym.e_sym, sym.e_count);
-#else  /* RLE_DMA_AXI */
-  printf("[%c, %u]%s\n", (char)sym.e_sym, sym.e_count,
-         sym.e_last ? " (last)" : "");
-#endif /* RLE_DMA_AXI */
-}
-
 void check_init(void) {
   if (_init_mcause != 0) {
     printf(
@@ -249,24 +93,197 @@ void check_init(void) {
       (unsigned)rv32_csr_read(CSR_MIE));
 }
 
-#define INPUT_BUF_STRLEN 256
-#define QUOTE(A) #A
-#define CAT3(A, B, C) #A QUOTE(B) #C
-#define FMT_INPUT_BUF CAT3(%, INPUT_BUF_STRLEN, s)
+#if defined(RLE_SINK) || defined(RLE_CORPUS)
+
+/* Encoder output goes to a memory sink (common/rle_sink.h) instead of the
+ * UART. With RLE_SINK_MEMORY the pairs are kept in `rle_sink_mem`, otherwise
+ * they're only folded into the digest. */
+#ifdef RLE_SINK_MEMORY
+#ifndef RLE_SINK_MEM_RECS
+#define RLE_SINK_MEM_RECS 65536
+#endif
+static rle_sink_rec_t rle_sink_mem[RLE_SINK_MEM_RECS];
+#define RLE_SINK_BUF rle_sink_mem
+#else
+#define RLE_SINK_MEM_RECS 0
+#define RLE_SINK_BUF NULL
+#endif
+
+static void print_sink(const char* tag, const rle_sink_t* sink) {
+  printf("[%s] %lu runs, %lu symbols, crc32 %08lx (%s)", tag,
+         sink->s_records, sink->s_symbols, sink->s_crc, crc32_impl());
+#ifdef RLE_SINK_MEMORY
+  printf(", %u stored at %p", sink->s_len, sink->s_buf);
+#endif
+  printf("\n");
+}
+
+#endif /* RLE_SINK || RLE_CORPUS */
+
+#ifdef RLE_CORPUS
+
+/* Corpus mode. The corpus placed in RAM by the simulator is encoded in one
+ * go and only a summary is printed, so that the throughput isn't bound by
+ * the UART. Runs go to the memory sink and the sum of their counts must
+ * match the length of the corpus. */
+
+static void run_corpus(void) {
+  const corpus_hdr_t* hdr;
+  int err;
+  if ((err = corpus_open(CORPUS_ADDR, CORPUS_SIZE, &hdr))) {
+    printf("[CORPUS] No corpus at 0x%08x: %s\n", CORPUS_ADDR,
+           corpus_err_name(err));
+    return;
+  }
+
+  rle_sink_t sink;
+  rle_coalesce_t coalesce;
+  rle_sink_init(&sink, RLE_SINK_BUF, RLE_SINK_MEM_RECS);
+  rle_coalesce_init(&coalesce, rle_sink_push_run, &sink);
+
+  set_rle_link_quiet(&rle_link, 1);
+  rle_link.l_timeouts = 0;
+  uint64_t start      = rv32_cycles64();
+  PERF_PHASE_BEGIN(PERF_PHASE_ENCODE);
+  run_text_rle_chan(&rle_link, corpus_data(hdr), hdr->ch_len, &coalesce,
+                    rle_coalesce_push);
+  rle_coalesce_finish(&coalesce);
+  PERF_PHASE_END(PERF_PHASE_ENCODE);
+  uint64_t cycles = rv32_cycles64() - start;
+  set_rle_link_quiet(&rle_link, 0);
+
+  printf("[CORPUS] %lu bytes via %s, %lu records, %s\n", hdr->ch_len,
+         rle_link.l_name, coalesce.c_records_in,
+         sink.s_symbols == hdr->ch_len ? "OK" : "FAILED (length mismatch)");
+  print_sink("CORPUS", &sink);
+  printf("[CORPUS] %lu kcycles, %lu bytes/s, %lu records/s\n",
+         (unsigned long)(cycles / 1000),
+         (unsigned long)((uint64_t)hdr->ch_len * CPU_FREQ_HZ /
+                         (cycles ? cycles : 1)),
+         (unsigned long)((uint64_t)coalesce.c_records_in * CPU_FREQ_HZ /
+                         (cycles ? cycles : 1)));
+  /* Chunks that didn't end on e_last include the idle timeout */
+  if (rle_link.l_timeouts) {
+    printf("[CORPUS] %lu chunks timed out, throughput includes the waits\n",
+           rle_link.l_timeouts);
+  }
+}
+
+#endif /* RLE_CORPUS */
+
+#ifndef RLE_PIPELINE
+/* Console commands start with '/' and are executed instead of being encoded.
+ * Returns 1 if `input` was a command. */
+static int run_command(const char* input) {
+  if (input[0] != '/') return 0;
+
+#ifdef TRACE_ENABLED
+  if (!strcmp(input, "/trace")) {
+    fflush(stdout);
+    trace_dump();
+    printf("\n");
+    return 1;
+  }
+  if (!strcmp(input, "/trace-reset")) {
+    trace_reset();
+    return 1;
+  }
+#endif /* TRACE_ENABLED */
+#ifdef MMIO_STATS
+  if (!strcmp(input, "/mmio")) {
+    mmio_stats_print();
+    return 1;
+  }
+  if (!strcmp(input, "/mmio-reset")) {
+    mmio_stats_reset();
+    return 1;
+  }
+#endif /* MMIO_STATS */
+#ifdef RLE_LATENCY
+  if (!strcmp(input, "/lat")) {
+    rle_lat_print();
+    return 1;
+  }
+  if (!strcmp(input, "/lat-reset")) {
+    rle_lat_reset();
+    return 1;
+  }
+#endif /* RLE_LATENCY */
+#if defined(RLE_ROUNDTRIP) && defined(RLE_DMA) && defined(RLE_DMA_IRQ)
+  if (!strcmp(input, "/irq-bench")) {
+    run_irq_bench();
+    return 1;
+  }
+#endif
+#ifdef RLE_AUTOTUNE
+  if (!strcmp(input, "/chunk")) {
+    rle_tune_print();
+    return 1;
+  }
+  if (!strcmp(input, "/chunk-tune")) {
+    rle_tune_chunk();
+    return 1;
+  }
+  if (!strncmp(input, "/chunk=", strlen("/chunk="))) {
+    rle_tune_set(input + strlen("/chunk="));
+    return 1;
+  }
+#endif /* RLE_AUTOTUNE */
+#ifdef RLE_CORPUS
+  if (!strcmp(input, "/corpus")) {
+    run_corpus();
+    return 1;
+  }
+#endif /* RLE_CORPUS */
+  if (!strcmp(input, "/transport")) {
+    for (size_t i = 0; i < rle_link_cnt; ++i) {
+      printf("%c %s\n", rle_links[i].ld_name == rle_link.l_name ? '*' : ' ',
+             rle_links[i].ld_name);
+    }
+    return 1;
+  }
+  if (!strncmp(input, "/transport=", strlen("/transport="))) {
+    const char* name = input + strlen("/transport=");
+    for (size_t i = 0; i < rle_link_cnt; ++i) {
+      if (!strcmp(name, rle_links[i].ld_name)) {
+        /* Fall back to the default transport if the channels can't be
+         * opened */
+        if (open_rle_link(&rle_links[i])) {
+          open_rle_link(&rle_links[rle_link_cnt - 1]);
+        }
+        printf("[INFO] Transport: %s\n", rle_link.l_name);
+#ifdef RLE_AUTOTUNE
+        /* The best chunk size depends on the transport */
+        rle_tune_chunk();
+#endif
+        return 1;
+      }
+    }
+  }
+
+  printf("Unknown command: %s\n", input);
+  return 1;
+}
+#endif /* RLE_PIPELINE */
 
 int main(void) {
   check_init();
 
-  char rle_input[INPUT_BUF_STRLEN + 1];
-
 #ifdef RLE_DMA
 #ifdef RLE_DMA_IRQ
   interrupt_init_external();
   interrupt_enable_external(RLE_DMA_IRQ_NUM);
+#ifdef RLE_ROUNDTRIP
+  interrupt_enable_external(RLE_DEC_DMA_IRQ_NUM);
+#endif
 
   uint32_t priority_cnt;
-  if ((priority_cnt = interrupt_priority_count()))
+  if ((priority_cnt = interrupt_priority_count())) {
     interrupt_set_priority(RLE_DMA_IRQ_NUM, priority_cnt - 1);
+#ifdef RLE_ROUNDTRIP
+    interrupt_set_priority(RLE_DEC_DMA_IRQ_NUM, priority_cnt - 1);
+#endif
+  }
 
   rv32_csr_write(CSR_MIE, (uint32_t)1 << 11);   /* mie.MEIE=1 */
   rv32_csr_write(CSR_MSTATUS, (uint32_t)1 << 3); /* mstatus.MIE=1 */
@@ -276,29 +293,139 @@ int main(void) {
     printf("DMA NOT OK\n");
     return 0;
   }
+  if (alloc_rle_dma_chans()) {
+    return 0;
+  }
+
+#endif /* RLE_DMA */
+
+  xls_dma_pool_init(&dma_buf_pool);
+  if (open_rle_link(&rle_links[rle_link_cnt - 1])) {
+    return 0;
+  }
 
 #ifdef PRINT_DMA_ADDRS
-  printf("dma_tsfr_in_buf addr: %p\n", dma_tsfr_in_buf);
-  printf("dma_tsfr_out_buf addr: %p\n", dma_tsfr_out_buf);
+  printf("dma_buf_pool addr: %p, %u blocks of %u bytes\n",
+         dma_buf_pool.pool_mem, dma_buf_pool.pool_block_cnt,
+         xls_dma_pool_block_size(&dma_buf_pool));
 #endif
+  printf("[INFO] Transport: %s\n", rle_link.l_name);
+#ifdef RLE_HYBRID
+  if (rle_hybrid_init()) {
+    return 0;
+  }
+#endif
+#ifdef RLE_ROUNDTRIP
+  if (open_rle_dec_link(&rle_dec_link)) {
+    return 0;
+  }
 #endif
 
   printf("[INFO] Input symbol size: %d bytes\n", sizeof(rle_enc_in_data_t));
   printf("[INFO] Output symbol size: %d bytes\n", sizeof(rle_enc_out_data_t));
+  printf("[INFO] Symbol width: %d bits\n", RLE_SYMBOL_WIDTH);
+
+#ifdef RLE_AUTOTUNE
+  rle_tune_chunk();
+#endif
+#ifdef RLE_CORPUS
+  run_corpus();
+#endif
+
+#if defined(RLE_PIPELINE)
+  run_pipeline();
+#elif defined(RLE_BATCH)
+  run_batches(run_command);
+#else
+  char rle_input[INPUT_BUF_STRLEN + 1];
+
+#ifdef RLE_SINK
+  rle_sink_t sink;
+#endif
+#ifdef RLE_COALESCE
+  rle_coalesce_t coalesce;
+  on_encoded_t on_encoded = rle_coalesce_push;
+  void* on_encoded_ctx    = &coalesce;
+#elif defined(RLE_SINK)
+  on_encoded_t on_encoded = rle_sink_push;
+  void* on_encoded_ctx    = &sink;
+#else
+  on_encoded_t on_encoded = print_encoded_sym;
+  void* on_encoded_ctx    = NULL;
+#endif
 
   while (1) {
     printf("Enter RLE input:\n");
     scanf(FMT_INPUT_BUF, rle_input);
+    if (run_command(rle_input)) {
+      continue;
+    }
 
     printf("RLE input: %s\n", rle_input);
     printf("Running RLE...\n");
-#ifdef RLE_DMA
-    run_text_rle_dma(rle_input, NULL, print_encoded_sym);
+#ifdef RLE_SINK
+    rle_sink_init(&sink, RLE_SINK_BUF, RLE_SINK_MEM_RECS);
+#endif
+#if defined(RLE_COALESCE) && defined(RLE_SINK)
+    rle_coalesce_init(&coalesce, rle_sink_push_run, &sink);
+#elif defined(RLE_COALESCE)
+    rle_coalesce_init(&coalesce, print_encoded_run, NULL);
+#endif
+#ifdef RLE_BENCH
+    bench_bytes_moved    = 0;
+#ifdef RLE_DMA_IRQ
+    interrupt_stats_t bench_irq_start, bench_irq_end;
+    interrupt_get_stats(&bench_irq_start);
+#endif
+    uint32_t bench_start = rv32_csr_read(CSR_MCYCLE);
+#endif
+    MMIO_REQUEST_BEGIN();
+    PERF_PHASE_BEGIN(PERF_PHASE_ENCODE);
+#if defined(RLE_ROUNDTRIP)
+    run_roundtrip(rle_input, on_encoded_ctx, on_encoded);
+#elif defined(RLE_HYBRID)
+    /* Latency is recorded per picked transport */
+    run_text_rle_hybrid(rle_input, on_encoded_ctx, on_encoded);
+#elif defined(RLE_LATENCY)
+    run_text_rle_timed(rle_input, on_encoded_ctx, on_encoded);
 #else
-    run_text_rle(rle_input, NULL, print_encoded_sym);
+    run_text_rle_chan(&rle_link, rle_input, strlen(rle_input), on_encoded_ctx,
+                      on_encoded);
+#endif
+#ifdef RLE_COALESCE
+    rle_coalesce_finish(&coalesce);
+#endif
+    fmt_flush(&rec_fmt);
+    PERF_PHASE_END(PERF_PHASE_ENCODE);
+    MMIO_REQUEST_END(strlen(rle_input));
+#ifdef RLE_ROUNDTRIP
+    print_roundtrip_stats();
+#endif
+#ifdef RLE_SINK
+    print_sink("SINK", &sink);
+#endif
+#ifdef RLE_BENCH
+    uint32_t bench_cycles = rv32_csr_read(CSR_MCYCLE) - bench_start;
+    size_t bench_len      = strlen(rle_input);
+    printf(
+        "[BENCH] %u symbols, %lu cycles, %lu cycles/symbol, "
+        "%lu bytes moved\n",
+        bench_len, bench_cycles, bench_len ? bench_cycles / bench_len : 0,
+        bench_bytes_moved);
+#ifdef RLE_DMA_IRQ
+    interrupt_get_stats(&bench_irq_end);
+    printf("[BENCH] %lu interrupts in %lu traps\n",
+           bench_irq_end.is_irqs - bench_irq_start.is_irqs,
+           bench_irq_end.is_traps - bench_irq_start.is_traps);
+#endif
+#endif
+#ifdef RLE_COALESCE
+    printf("[INFO] Coalesced %lu records into %lu runs\n",
+           coalesce.c_records_in, coalesce.c_runs_out);
 #endif
     printf("\n");
   }
+#endif
 
   return 0;
 }
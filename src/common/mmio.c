@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "mmio.h"
+
+#ifdef MMIO_STATS
+
+#include <stdio.h>
+
+#include "cpu/riscv_csr.h"
+
+/* Must be a power of two */
+#define MMIO_REG_SLOTS 64
+
+typedef struct mmio_reg {
+  uintptr_t mr_addr;
+  const char* mr_name; /* Expression of the first access */
+  uint32_t mr_reads;
+  uint32_t mr_writes;
+} mmio_reg_t;
+
+static const char* const mmio_dev_names[MMIO_DEV_CNT] = {
+    [MMIO_DEV_XLS]  = "xls",
+    [MMIO_DEV_UART] = "uart",
+};
+
+mmio_totals_t mmio_totals[MMIO_DEV_CNT];
+static mmio_site_t* mmio_sites;
+static mmio_reg_t mmio_regs[MMIO_REG_SLOTS];
+static uint32_t mmio_regs_dropped;
+
+static mmio_reg_t* find_reg(uintptr_t addr, const char* name) {
+  uint32_t slot = (addr >> 2) & (MMIO_REG_SLOTS - 1);
+  for (int i = 0; i < MMIO_REG_SLOTS; ++i) {
+    mmio_reg_t* reg = &mmio_regs[(slot + i) & (MMIO_REG_SLOTS - 1)];
+    if (reg->mr_addr == addr) return reg;
+    if (!reg->mr_name) {
+      reg->mr_addr = addr;
+      reg->mr_name = name;
+      return reg;
+    }
+  }
+  return NULL;
+}
+
+void mmio_count(mmio_site_t* site, const volatile void* addr, uint32_t reads,
+                uint32_t writes) {
+  uint32_t irq_state = rv32_irq_save();
+
+  if (!site->ms_registered) {
+    site->ms_registered = 1;
+    site->ms_next       = mmio_sites;
+    mmio_sites          = site;
+  }
+
+  site->ms_reads += reads;
+  site->ms_writes += writes;
+  mmio_totals[site->ms_dev].mt_reads += reads;
+  mmio_totals[site->ms_dev].mt_writes += writes;
+
+  mmio_reg_t* reg = find_reg((uintptr_t)addr, site->ms_reg);
+  if (reg) {
+    reg->mr_reads += reads;
+    reg->mr_writes += writes;
+  } else {
+    ++mmio_regs_dropped;
+  }
+
+  rv32_irq_restore(irq_state);
+}
+
+void mmio_stats_print(void) {
+  printf("[MMIO] Per device (reads/writes):\n");
+  for (int i = 0; i < MMIO_DEV_CNT; ++i) {
+    printf("  %-5s %8lu %8lu\n", mmio_dev_names[i], mmio_totals[i].mt_reads,
+           mmio_totals[i].mt_writes);
+  }
+
+  printf("[MMIO] Per call site (reads/writes):\n");
+  for (mmio_site_t* site = mmio_sites; site; site = site->ms_next) {
+    if (!site->ms_reads && !site->ms_writes) continue;
+    printf("  %8lu %8lu  %s:%u %s\n", site->ms_reads, site->ms_writes,
+           site->ms_func, site->ms_line, site->ms_reg);
+  }
+
+  printf("[MMIO] Per register (reads/writes):\n");
+  for (int i = 0; i < MMIO_REG_SLOTS; ++i) {
+    mmio_reg_t* reg = &mmio_regs[i];
+    if (!reg->mr_reads && !reg->mr_writes) continue;
+    printf("  0x%08lx %8lu %8lu  %s\n", (unsigned long)reg->mr_addr,
+           reg->mr_reads, reg->mr_writes, reg->mr_name);
+  }
+  if (mmio_regs_dropped) {
+    printf("  %lu accesses to untracked registers\n", mmio_regs_dropped);
+  }
+}
+
+void mmio_stats_reset(void) {
+  uint32_t irq_state = rv32_irq_save();
+  for (mmio_site_t* site = mmio_sites; site; site = site->ms_next) {
+    site->ms_reads  = 0;
+    site->ms_writes = 0;
+  }
+  for (int i = 0; i < MMIO_REG_SLOTS; ++i) {
+    mmio_regs[i].mr_reads  = 0;
+    mmio_regs[i].mr_writes = 0;
+  }
+  for (int i = 0; i < MMIO_DEV_CNT; ++i) {
+    mmio_totals[i].mt_reads  = 0;
+    mmio_totals[i].mt_writes = 0;
+  }
+  mmio_regs_dropped = 0;
+  rv32_irq_restore(irq_state);
+}
+
+#endif /* MMIO_STATS */
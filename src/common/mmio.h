@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_MMIO_H_
+#define COMMON_MMIO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Register accessors.
+ *
+ * Drivers access device registers through MMIO_READ and MMIO_WRITE. Normally
+ * they compile to plain volatile accesses. With MMIO_STATS every access is
+ * also counted per call site, per register address and per device, as a
+ * number of 32-bit bus transactions (a 64-bit register takes two). This makes
+ * it possible to compare driver changes by the exact number of round trips to
+ * the simulated peripherals. */
+
+typedef enum mmio_dev {
+  MMIO_DEV_XLS,
+  MMIO_DEV_UART,
+  MMIO_DEV_CNT,
+} mmio_dev_t;
+
+#ifdef MMIO_STATS
+
+typedef struct mmio_site {
+  const char* ms_reg; /* Accessed expression */
+  const char* ms_func;
+  uint16_t ms_line;
+  uint8_t ms_dev;
+  uint8_t ms_registered;
+  uint32_t ms_reads;
+  uint32_t ms_writes;
+  struct mmio_site* ms_next;
+} mmio_site_t;
+
+typedef struct mmio_totals {
+  uint32_t mt_reads;
+  uint32_t mt_writes;
+} mmio_totals_t;
+
+extern mmio_totals_t mmio_totals[MMIO_DEV_CNT];
+
+void mmio_count(mmio_site_t* site, const volatile void* addr, uint32_t reads,
+                uint32_t writes);
+
+/* Number of 32-bit bus transactions needed to access `reg` */
+#define MMIO_OPS(reg) (sizeof(reg) > 4 ? (sizeof(reg) + 3) / 4 : 1)
+
+#define MMIO_COUNT(dev, name, addr, reads, writes)                     \
+  do {                                                                 \
+    static mmio_site_t mmio_site_ = {name, __func__, __LINE__, (dev)}; \
+    mmio_count(&mmio_site_, (addr), (reads), (writes));                \
+  } while (0)
+
+#define MMIO_READ(dev, reg)                            \
+  ({                                                   \
+    MMIO_COUNT(dev, #reg, &(reg), MMIO_OPS(reg), 0);   \
+    (reg);                                             \
+  })
+
+#define MMIO_WRITE(dev, reg, val)                      \
+  do {                                                 \
+    MMIO_COUNT(dev, #reg, &(reg), 0, MMIO_OPS(reg));   \
+    (reg) = (val);                                     \
+  } while (0)
+
+/* Bit-fields have no address, so writes to them are counted against the
+ * enclosing register, as the single-byte read-modify-write they compile to */
+#define MMIO_WRITE_BITS(dev, reg, field, val)           \
+  do {                                                  \
+    MMIO_COUNT(dev, #reg "." #field, &(reg), 1, 1);     \
+    (reg).field = (val);                                \
+  } while (0)
+
+/* Prints the counters of every call site and register */
+void mmio_stats_print(void);
+void mmio_stats_reset(void);
+
+#else /* MMIO_STATS */
+
+#define MMIO_READ(dev, reg) (reg)
+#define MMIO_WRITE(dev, reg, val) \
+  do {                            \
+    (reg) = (val);                \
+  } while (0)
+#define MMIO_WRITE_BITS(dev, reg, field, val) \
+  do {                                        \
+    (reg).field = (val);                      \
+  } while (0)
+
+#endif /* MMIO_STATS */
+
+#define MMIO_SET(dev, reg, bits) \
+  MMIO_WRITE(dev, reg, MMIO_READ(dev, reg) | (bits))
+#define MMIO_CLEAR(dev, reg, bits) \
+  MMIO_WRITE(dev, reg, MMIO_READ(dev, reg) & ~(bits))
+
+#endif /* COMMON_MMIO_H_ */
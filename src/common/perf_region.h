@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_PERF_REGION_H_
+#define COMMON_PERF_REGION_H_
+
+/* Region markers for simulator statistics.
+ *
+ * A phase resets the simulator statistics when it begins and dumps them when
+ * it ends, so each phase gets its own section in gem5's stats.txt. Phases
+ * must not be nested. Work items only mark their begin and end, and can be
+ * used for shorter, possibly overlapping events like DMA transfers.
+ *
+ * With M5OPS_ENABLED the markers are gem5 m5ops, otherwise they expand to
+ * nothing. */
+
+enum perf_phase {
+  PERF_PHASE_ENCODE = 1,
+};
+
+/* Work item IDs of DMA transfers, one per channel */
+#define PERF_WORK_DMA(chan) (0x100 + (chan))
+
+#ifdef M5OPS_ENABLED
+
+#include "platform/demo-gem5/m5ops.h"
+
+#define PERF_PHASE_BEGIN(id) \
+  do {                       \
+    m5_work_begin((id), 0);  \
+    m5_reset_stats(0, 0);    \
+  } while (0)
+
+#define PERF_PHASE_END(id) \
+  do {                     \
+    m5_dump_stats(0, 0);   \
+    m5_work_end((id), 0);  \
+  } while (0)
+
+#define PERF_WORK_BEGIN(id) m5_work_begin((id), 0)
+#define PERF_WORK_END(id)   m5_work_end((id), 0)
+
+#else /* M5OPS_ENABLED */
+
+#define PERF_PHASE_BEGIN(id) \
+  do {                       \
+  } while (0)
+#define PERF_PHASE_END(id) \
+  do {                     \
+  } while (0)
+#define PERF_WORK_BEGIN(id) \
+  do {                      \
+  } while (0)
+#define PERF_WORK_END(id) \
+  do {                    \
+  } while (0)
+
+#endif /* M5OPS_ENABLED */
+
+#endif /* COMMON_PERF_REGION_H_ */
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_batch.h"
+
+#ifdef RLE_BATCH
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/perf_region.h"
+#include "common/rle_coalesce.h"
+#include "common/rle_link.h"
+#include "common/rle_print.h"
+#include "cpu/riscv_csr.h"
+#ifdef DEV_LITEUART
+#include "dev/liteuart.h"
+#endif
+#ifdef DEV_SIMPLEUART
+#include "dev/simpleuart.h"
+#endif
+
+#define RLE_BATCH_LINE_LEN 1024
+#define RLE_BATCH_MAX_REQS 32
+
+typedef void (*on_request_done_t)(void* ctx, size_t idx);
+
+typedef struct rle_batch {
+  char* b_reqs[RLE_BATCH_MAX_REQS];
+  size_t b_cnt;
+  size_t b_syms;
+#ifdef RLE_COALESCE
+  rle_coalesce_t b_coalesce;
+#endif
+} rle_batch_t;
+
+/* Requests of the batch in flight whose e_last hasn't been received yet */
+static size_t rle_batch_pending;
+
+/* The output of a batch ends with the e_last of its last request */
+static int rle_batch_out_is_last(const void* rec) {
+  return rle_out_is_last(rec) && --rle_batch_pending == 0;
+}
+
+/* Encodes `cnt` requests with a single pair of transfers. All requests
+ * together must not exceed DMATSFR_BUF_LEN symbols. Returns the number of
+ * completed requests. */
+static size_t run_rle_batch(char* const* reqs, size_t cnt, void* ctx,
+                            on_encoded_t on_encoded,
+                            on_request_done_t on_done) {
+  rle_enc_in_data_t* in_buf   = xls_dma_pool_alloc(&dma_buf_pool);
+  rle_enc_out_data_t* out_buf = xls_dma_pool_alloc(&dma_buf_pool);
+  size_t done                 = 0;
+
+  if (!in_buf || !out_buf) {
+    print_tsfr_error(XLS_DMA_NOMEM);
+    goto out;
+  }
+
+  size_t syms = 0;
+  for (size_t i = 0; i < cnt; ++i) {
+    size_t len = strlen(reqs[i]);
+    prepare_dma_input_buf(&in_buf[syms], reqs[i], len);
+    syms += len;
+  }
+
+  rle_batch_pending = cnt;
+  xls_chan_end_on(&rle_link.l_out, sizeof(rle_enc_out_data_t),
+                  rle_batch_out_is_last);
+  xls_chan_set_final(&rle_link.l_in, 1);
+  xls_chan_set_final(&rle_link.l_out, 1);
+
+  /* Every run is at least one symbol long */
+  if (submit_rle_chan(&rle_link.l_out, out_buf,
+                      syms * sizeof(rle_enc_out_data_t))) {
+    goto out;
+  }
+  if (submit_rle_chan(&rle_link.l_in, in_buf,
+                      syms * sizeof(rle_enc_in_data_t))) {
+    xls_chan_cancel(&rle_link.l_out);
+    goto out;
+  }
+  if (complete_rle_chans(&rle_link)) {
+    goto out;
+  }
+  BENCH_COUNT_BYTES(xls_chan_transferred(&rle_link.l_in) +
+                    xls_chan_transferred(&rle_link.l_out));
+  MMIO_COUNT_CHUNK();
+
+  size_t records =
+      xls_chan_transferred(&rle_link.l_out) / sizeof(rle_enc_out_data_t);
+  for (size_t i = 0; i < records && done < cnt; ++i) {
+    on_encoded(ctx, out_buf[i]);
+    if (out_buf[i].e_last) {
+      on_done(ctx, done++);
+    }
+  }
+
+out:
+  xls_chan_end_on(&rle_link.l_out, sizeof(rle_enc_out_data_t),
+                  rle_out_is_last);
+  if (in_buf) xls_dma_pool_free(&dma_buf_pool, in_buf);
+  if (out_buf) xls_dma_pool_free(&dma_buf_pool, out_buf);
+  return done;
+}
+
+/* Reads a non-empty line, without the line terminator */
+static void read_line(char* buf, size_t len) {
+  size_t pos = 0;
+  while (1) {
+    char c = uart_getc();
+    if (c == '\r' || c == '\n') {
+      if (pos) break;
+      continue;
+    }
+    if (pos < len - 1) buf[pos++] = c;
+  }
+  buf[pos] = '\0';
+}
+
+static void print_request_done(void* ctx, size_t idx) {
+#ifdef RLE_COALESCE
+  rle_coalesce_t* coalesce = (rle_coalesce_t*)ctx;
+  rle_coalesce_finish(coalesce);
+  fmt_flush(&rec_fmt);
+  printf("[INFO] Request %u done, coalesced %lu records into %lu runs\n", idx,
+         coalesce->c_records_in, coalesce->c_runs_out);
+  rle_coalesce_init(coalesce, print_encoded_run, NULL);
+#else  /* RLE_COALESCE */
+  fmt_flush(&rec_fmt);
+  printf("[INFO] Request %u done\n", idx);
+#endif /* RLE_COALESCE */
+}
+
+static void flush_batch(rle_batch_t* batch) {
+  if (!batch->b_cnt) return;
+
+  printf("Running RLE on a batch of %u requests...\n", batch->b_cnt);
+#ifdef RLE_COALESCE
+  rle_coalesce_init(&batch->b_coalesce, print_encoded_run, NULL);
+  void* ctx               = &batch->b_coalesce;
+  on_encoded_t on_encoded = rle_coalesce_push;
+#else
+  void* ctx               = NULL;
+  on_encoded_t on_encoded = print_encoded_sym;
+#endif
+#ifdef RLE_BENCH
+  bench_bytes_moved    = 0;
+  uint32_t bench_start = rv32_csr_read(CSR_MCYCLE);
+#endif
+  MMIO_REQUEST_BEGIN();
+  PERF_PHASE_BEGIN(PERF_PHASE_ENCODE);
+  size_t done = run_rle_batch(batch->b_reqs, batch->b_cnt, ctx, on_encoded,
+                              print_request_done);
+  fmt_flush(&rec_fmt);
+  PERF_PHASE_END(PERF_PHASE_ENCODE);
+  MMIO_REQUEST_END(batch->b_syms);
+#ifdef RLE_BENCH
+  uint32_t bench_cycles = rv32_csr_read(CSR_MCYCLE) - bench_start;
+  printf(
+      "[BENCH] %u requests, %u symbols, %lu cycles, %lu cycles/symbol, "
+      "%lu bytes moved\n",
+      batch->b_cnt, batch->b_syms, bench_cycles, bench_cycles / batch->b_syms,
+      bench_bytes_moved);
+#endif
+  if (done != batch->b_cnt) {
+    printf("[ERROR] Only %u of %u requests have been completed\n", done,
+           batch->b_cnt);
+  }
+
+  batch->b_cnt  = 0;
+  batch->b_syms = 0;
+}
+
+void run_batches(int (*run_command)(const char* input)) {
+  static char line[RLE_BATCH_LINE_LEN + 1];
+  static rle_batch_t batch;
+
+  while (1) {
+    printf("Enter RLE input:\n");
+    read_line(line, sizeof(line));
+
+    char* save;
+    for (char* req = strtok_r(line, " \t", &save); req;
+         req = strtok_r(NULL, " \t", &save)) {
+      size_t len = strlen(req);
+      if (req[0] == '/') {
+        flush_batch(&batch);
+        run_command(req);
+        continue;
+      }
+      if (len > DMATSFR_BUF_LEN) {
+        printf("[ERROR] Request of %u symbols exceeds the batch size\n", len);
+        continue;
+      }
+      if (batch.b_cnt == RLE_BATCH_MAX_REQS ||
+          batch.b_syms + len > DMATSFR_BUF_LEN) {
+        flush_batch(&batch);
+      }
+      batch.b_reqs[batch.b_cnt++] = req;
+      batch.b_syms += len;
+    }
+    flush_batch(&batch);
+    printf("\n");
+  }
+}
+
+#endif /* RLE_BATCH */
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_BATCH_H_
+#define COMMON_RLE_BATCH_H_
+
+/* Batched mode (BATCH=yes).
+ *
+ * An input line may hold several requests separated with whitespace.
+ * Consecutive requests are encoded together as long as they fit into one DMA
+ * buffer, each ending with its own e_last, so the transfer setup is paid once
+ * per batch instead of once per request. The output is split back into
+ * requests on e_last. */
+
+/* Reads and encodes input lines forever. Words starting with '/' are passed
+ * to `run_command` instead of being encoded. */
+void run_batches(int (*run_command)(const char* input));
+
+#endif /* COMMON_RLE_BATCH_H_ */
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_coalesce.h"
+
+void rle_coalesce_init(rle_coalesce_t* coalesce, on_run_t callback,
+                       void* ctx) {
+  coalesce->c_callback    = callback;
+  coalesce->c_ctx         = ctx;
+  coalesce->c_has_pending = 0;
+  coalesce->c_records_in  = 0;
+  coalesce->c_runs_out    = 0;
+}
+
+static void emit_pending(rle_coalesce_t* coalesce, uint8_t last) {
+  coalesce->c_pending.r_last = last;
+  coalesce->c_callback(coalesce->c_ctx, coalesce->c_pending);
+  coalesce->c_has_pending = 0;
+  ++coalesce->c_runs_out;
+}
+
+void rle_coalesce_push(void* ctx, rle_enc_out_data_t rec) {
+  rle_coalesce_t* coalesce = (rle_coalesce_t*)ctx;
+  uint32_t count           = rec.e_count;
+
+  ++coalesce->c_records_in;
+  if (count == 0) return;
+
+  if (coalesce->c_has_pending) {
+    rle_run_t* run = &coalesce->c_pending;
+    if (run->r_sym == rec.e_sym && run->r_count <= UINT32_MAX - count) {
+      run->r_count += count;
+      return;
+    }
+    emit_pending(coalesce, 0);
+  }
+
+  coalesce->c_pending.r_sym   = rec.e_sym;
+  coalesce->c_pending.r_count = count;
+  coalesce->c_has_pending     = 1;
+}
+
+void rle_coalesce_finish(rle_coalesce_t* coalesce) {
+  if (coalesce->c_has_pending) {
+    emit_pending(coalesce, 1);
+  }
+}
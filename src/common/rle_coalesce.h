@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_COALESCE_H_
+#define COMMON_RLE_COALESCE_H_
+
+#include <stdint.h>
+
+#include "dev/rle.h"
+
+/* Output-side coalescing of encoder records.
+ *
+ * The encoder's count is only RLE_COUNT_WIDTH bits wide, so a long run comes
+ * out as a series of saturated records and every DMA chunk ends with its own
+ * `e_last`, splitting runs at chunk seams. The coalescer sits between the
+ * encoder and the consumer, merges adjacent records with the same symbol into
+ * a single wide-count run, ignores the per-chunk `e_last` markers and emits
+ * exactly one run marked as last when the request is finished. */
+
+typedef struct rle_run {
+  rle_sym_t r_sym;
+  uint32_t r_count;
+  uint8_t r_last;
+} rle_run_t;
+
+typedef void (*on_run_t)(void*, rle_run_t);
+
+typedef struct rle_coalesce {
+  on_run_t c_callback;
+  void* c_ctx;
+  rle_run_t c_pending;
+  uint8_t c_has_pending;
+  uint32_t c_records_in; /* Encoder records consumed since init */
+  uint32_t c_runs_out;   /* Runs emitted since init */
+} rle_coalesce_t;
+
+void rle_coalesce_init(rle_coalesce_t* coalesce, on_run_t callback, void* ctx);
+
+/* Has the signature of `on_encoded_t`, `coalesce` is a `rle_coalesce_t*` */
+void rle_coalesce_push(void* coalesce, rle_enc_out_data_t rec);
+
+/* Emits the pending run marked as last */
+void rle_coalesce_finish(rle_coalesce_t* coalesce);
+
+#endif /* COMMON_RLE_COALESCE_H_ */
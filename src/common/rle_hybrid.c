@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_hybrid.h"
+
+#ifdef RLE_HYBRID
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/rle_latency.h"
+#include "common/rle_print.h"
+#include "cpu/riscv_csr.h"
+
+#define RLE_HYBRID_BINS 10
+#define RLE_HYBRID_PROBE_PERIOD 32
+
+typedef enum rle_transport {
+  RLE_TRANSPORT_STREAM,
+  RLE_TRANSPORT_DMA,
+  RLE_TRANSPORT_CNT,
+} rle_transport_t;
+
+typedef struct rle_hybrid_bin {
+  uint32_t hb_cost[RLE_TRANSPORT_CNT]; /* cycles/symbol * 16, 0 if unknown */
+  uint32_t hb_requests;
+} rle_hybrid_bin_t;
+
+static rle_hybrid_bin_t rle_hybrid_bins[RLE_HYBRID_BINS];
+
+/* Stream channels of the second encoder instance, used while `rle_link` is
+ * a DMA link */
+static rle_link_t rle_hybrid_stream;
+
+int rle_hybrid_init(void) {
+  int err;
+  if ((err = open_rle_stream_link(&rle_hybrid_stream))) {
+    print_tsfr_error(err);
+    return err;
+  }
+  rle_hybrid_stream.l_name = xls_chan_name(&rle_hybrid_stream.l_in);
+  return XLS_DMA_OK;
+}
+
+static size_t rle_hybrid_bin_idx(size_t len) {
+  size_t bin = 0;
+  while (len >>= 1) ++bin;
+  return MIN(bin, RLE_HYBRID_BINS - 1);
+}
+
+static rle_transport_t rle_hybrid_pick(const rle_hybrid_bin_t* bin) {
+  for (int t = 0; t < RLE_TRANSPORT_CNT; ++t) {
+    if (bin->hb_cost[t] == 0) return (rle_transport_t)t;
+  }
+
+  rle_transport_t best =
+      bin->hb_cost[RLE_TRANSPORT_DMA] < bin->hb_cost[RLE_TRANSPORT_STREAM]
+          ? RLE_TRANSPORT_DMA
+          : RLE_TRANSPORT_STREAM;
+  if (bin->hb_requests % RLE_HYBRID_PROBE_PERIOD == 0) {
+    return best == RLE_TRANSPORT_DMA ? RLE_TRANSPORT_STREAM : RLE_TRANSPORT_DMA;
+  }
+  return best;
+}
+
+static void rle_hybrid_update(rle_hybrid_bin_t* bin, rle_transport_t t,
+                              uint32_t cycles, size_t len) {
+  /* cycles * 16 overflows 32 bits from 2^28 cycles on */
+  uint32_t sample = MIN(((uint64_t)cycles << 4) / len, UINT32_MAX);
+  if (sample == 0) sample = 1;
+
+  if (bin->hb_cost[t] == 0) {
+    bin->hb_cost[t] = sample;
+  } else {
+    /* EWMA with alpha = 1/4 */
+    bin->hb_cost[t] = bin->hb_cost[t] - (bin->hb_cost[t] >> 2) + (sample >> 2);
+  }
+  ++bin->hb_requests;
+}
+
+void run_text_rle_hybrid(const char* data, void* ctx, on_encoded_t callback) {
+  size_t len = strlen(data);
+  if (len == 0) return;
+
+  static rle_rec_buf_t recs;
+  rle_hybrid_bin_t* bin = &rle_hybrid_bins[rle_hybrid_bin_idx(len)];
+  rle_transport_t t     = RLE_TRANSPORT_STREAM;
+  rle_link_t* link      = &rle_link;
+  if (!xls_chan_is_stream(&rle_link.l_in)) {
+    t    = rle_hybrid_pick(bin);
+    link = t == RLE_TRANSPORT_DMA ? &rle_link : &rle_hybrid_stream;
+  }
+
+  /* Only the transport is timed, records are printed afterwards and
+   * transfers aren't reported */
+  rle_rec_buf_reset(&recs);
+  set_rle_link_quiet(link, 1);
+  uint32_t start = rv32_csr_read(CSR_MCYCLE);
+  run_text_rle_chan(link, data, len, &recs, rle_rec_buf_push);
+  uint32_t cycles = rv32_csr_read(CSR_MCYCLE) - start;
+  set_rle_link_quiet(link, 0);
+  rle_rec_buf_replay(&recs, ctx, callback);
+
+  rle_hybrid_update(bin, t, cycles, len);
+#ifdef RLE_LATENCY
+  rle_lat_record(link->l_name, len, cycles);
+#endif
+  fmt_flush(&rec_fmt);
+  printf("[INFO] Transport: %s, %lu cycles (%lu.%02lu cycles/symbol)\n",
+         link->l_name, cycles, cycles / len, (cycles % len) * 100 / len);
+}
+
+#endif /* RLE_HYBRID */
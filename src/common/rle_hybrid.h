@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_HYBRID_H_
+#define COMMON_RLE_HYBRID_H_
+
+#include "common/rle_link.h"
+
+/* Per-request transport selection (DMA=hybrid).
+ *
+ * Requests are binned by the bit length of their size and each bin keeps
+ * a moving average of cycles per symbol (in 1/16 of a cycle) for the stream
+ * link and for `rle_link`. A transport with no measurement in a bin is tried
+ * first, and every RLE_HYBRID_PROBE_PERIOD requests the currently slower one
+ * is given another chance, so the model follows changes in cost instead of
+ * locking onto the first winner. If the stream link has been selected with
+ * "/transport=stream", every request goes over it. */
+
+/* Opens the stream link, once at startup */
+int rle_hybrid_init(void);
+
+void run_text_rle_hybrid(const char* data, void* ctx, on_encoded_t callback);
+
+#endif /* COMMON_RLE_HYBRID_H_ */
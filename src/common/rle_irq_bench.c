@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_irq_bench.h"
+
+#if defined(RLE_ROUNDTRIP) && defined(RLE_DMA) && defined(RLE_DMA_IRQ)
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/mmio.h"
+#include "common/rle_link.h"
+#include "common/rle_roundtrip.h"
+#include "cpu/interrupts.h"
+#include "cpu/riscv_csr.h"
+#include "dev/rle_dec.h"
+
+#define IRQ_BENCH_ROUNDS 64
+#define IRQ_BENCH_SYMS 8
+#define IRQ_BENCH_CHANS 4
+
+static int irq_bench_chan_done(const xls_chan_t* ch) {
+  const xls_dma_session_t* sess = &ch->ch_sess;
+  return MMIO_READ(MMIO_DEV_XLS,
+                   sess->sess_dma->dma_chans[sess->sess_chan].dmach_ctrl) &
+         XLS_DMACH_CTRL_TSFRDONE;
+}
+
+static int irq_bench_round(rle_enc_in_data_t* in_buf,
+                           rle_enc_out_data_t* enc_buf,
+                           rle_dec_in_data_t* dec_in_buf,
+                           rle_dec_out_data_t* dec_buf) {
+  xls_chan_t* chans[IRQ_BENCH_CHANS] = {&rle_link.l_out, &rle_link.l_in,
+                                        &rle_dec_link.l_out,
+                                        &rle_dec_link.l_in};
+  void* bufs[IRQ_BENCH_CHANS]        = {enc_buf, in_buf, dec_buf, dec_in_buf};
+  size_t lens[IRQ_BENCH_CHANS]       = {
+      IRQ_BENCH_SYMS * sizeof(rle_enc_out_data_t),
+      IRQ_BENCH_SYMS * sizeof(rle_enc_in_data_t),
+      IRQ_BENCH_SYMS * sizeof(rle_dec_out_data_t),
+      IRQ_BENCH_SYMS * sizeof(rle_dec_in_data_t),
+  };
+  int err          = XLS_DMA_OK;
+  size_t submitted = 0;
+
+  uint32_t irq_state = rv32_irq_save();
+  while (!err && submitted < IRQ_BENCH_CHANS) {
+    /* Every transfer raises its interrupt, regardless of coalescing */
+    xls_chan_set_final(chans[submitted], 1);
+    if (!(err = xls_chan_submit(chans[submitted], bufs[submitted],
+                                lens[submitted]))) {
+      ++submitted;
+    }
+  }
+  for (uint64_t spins = 0; !err; ++spins) {
+    size_t done = 0;
+    for (size_t i = 0; i < IRQ_BENCH_CHANS; ++i) {
+      done += irq_bench_chan_done(chans[i]) != 0;
+    }
+    if (done == IRQ_BENCH_CHANS) break;
+    if (spins == RLE_TIMEOUT_CYCLES) err = XLS_DMA_TIMEOUT;
+  }
+  rv32_irq_restore(irq_state);
+
+  for (size_t i = 0; i < submitted; ++i) {
+    int status =
+        err ? XLS_DMA_TIMEOUT : xls_chan_complete(chans[i], RLE_TIMEOUT_CYCLES);
+    if (status == XLS_DMA_TIMEOUT) xls_chan_cancel(chans[i]);
+    if (!err) err = status;
+  }
+  return err;
+}
+
+void run_irq_bench(void) {
+  rle_enc_in_data_t* in_buf     = xls_dma_pool_alloc(&dma_buf_pool);
+  rle_enc_out_data_t* enc_buf   = xls_dma_pool_alloc(&dma_buf_pool);
+  rle_dec_in_data_t* dec_in_buf = xls_dma_pool_alloc(&dma_buf_pool);
+  rle_dec_out_data_t* dec_buf   = xls_dma_pool_alloc(&dma_buf_pool);
+  int err                       = XLS_DMA_NOMEM;
+  uint32_t rounds               = 0;
+  interrupt_stats_t start, end;
+
+  set_rle_link_quiet(&rle_link, 1);
+  interrupt_get_stats(&start);
+  if (in_buf && enc_buf && dec_in_buf && dec_buf) {
+    /* No two adjacent symbols are equal, so there's one record per symbol */
+    char syms[IRQ_BENCH_SYMS];
+    for (size_t i = 0; i < IRQ_BENCH_SYMS; ++i) {
+      syms[i] = 'a' + (i & 1);
+      memset(&dec_in_buf[i], 0, sizeof(dec_in_buf[i]));
+      dec_in_buf[i].e_sym   = syms[i];
+      dec_in_buf[i].e_count = 1;
+#ifndef RLE_DMA_AXI
+      dec_in_buf[i].e_last = (i == IRQ_BENCH_SYMS - 1);
+#endif
+    }
+    prepare_dma_input_buf(in_buf, syms, IRQ_BENCH_SYMS);
+
+    err = XLS_DMA_OK;
+    while (!err && rounds < IRQ_BENCH_ROUNDS) {
+      if (!(err = irq_bench_round(in_buf, enc_buf, dec_in_buf, dec_buf))) {
+        ++rounds;
+      }
+    }
+  }
+  interrupt_get_stats(&end);
+  set_rle_link_quiet(&rle_link, 0);
+  if (err) print_tsfr_error(err);
+
+  uint32_t traps = end.is_traps - start.is_traps;
+  uint32_t irqs  = end.is_irqs - start.is_irqs;
+  printf("[IRQ] %lu rounds, %lu interrupts in %lu traps, "
+         "%lu.%02lu interrupts/trap\n",
+         rounds, irqs, traps, traps ? irqs / traps : 0,
+         traps ? irqs * 100 / traps % 100 : 0);
+
+  if (in_buf) xls_dma_pool_free(&dma_buf_pool, in_buf);
+  if (enc_buf) xls_dma_pool_free(&dma_buf_pool, enc_buf);
+  if (dec_in_buf) xls_dma_pool_free(&dma_buf_pool, dec_in_buf);
+  if (dec_buf) xls_dma_pool_free(&dma_buf_pool, dec_buf);
+}
+
+#endif /* RLE_ROUNDTRIP && RLE_DMA && RLE_DMA_IRQ */
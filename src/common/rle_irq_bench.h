@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_IRQ_BENCH_H_
+#define COMMON_RLE_IRQ_BENCH_H_
+
+/* Interrupt microbenchmark ("/irq-bench" with ROUNDTRIP=yes and DMA=dma-irq).
+ *
+ * Each round encodes a request and decodes the same request, encoded
+ * beforehand, at the same time, over the current transport. Interrupts are
+ * masked until all four transfers are done, so the encoder and decoder DMA
+ * interrupts are both pending when the trap is taken. Reports the number of
+ * traps taken to service them. */
+
+void run_irq_bench(void);
+
+#endif /* COMMON_RLE_IRQ_BENCH_H_ */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_latency.h"
+
+#ifdef RLE_LATENCY
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/lat_hist.h"
+#include "cpu/riscv_csr.h"
+
+#define RLE_LAT_CLASSES 5
+#define RLE_LAT_TRANSPORTS 4
+
+typedef struct rle_lat_transport {
+  const char* lt_name; /* NULL if the slot is free */
+  lat_hist_t lt_hists[RLE_LAT_CLASSES];
+} rle_lat_transport_t;
+
+static rle_lat_transport_t rle_lat_transports[RLE_LAT_TRANSPORTS];
+
+static size_t rle_lat_class(size_t len) {
+  size_t cls = 0;
+  while (len >>= 2) ++cls;
+  return MIN(cls, RLE_LAT_CLASSES - 1);
+}
+
+void rle_lat_record(const char* transport, size_t len, uint32_t cycles) {
+  if (len == 0) return;
+
+  for (size_t i = 0; i < RLE_LAT_TRANSPORTS; ++i) {
+    rle_lat_transport_t* t = &rle_lat_transports[i];
+    if (!t->lt_name) {
+      t->lt_name = transport;
+      for (size_t c = 0; c < RLE_LAT_CLASSES; ++c) {
+        lat_hist_reset(&t->lt_hists[c]);
+      }
+    }
+    if (!strcmp(t->lt_name, transport)) {
+      lat_hist_record(&t->lt_hists[rle_lat_class(len)], cycles);
+      return;
+    }
+  }
+}
+
+void rle_lat_reset(void) {
+  for (size_t i = 0; i < RLE_LAT_TRANSPORTS; ++i) {
+    rle_lat_transports[i].lt_name = NULL;
+  }
+}
+
+void rle_lat_print(void) {
+  for (size_t i = 0; i < RLE_LAT_TRANSPORTS; ++i) {
+    const rle_lat_transport_t* t = &rle_lat_transports[i];
+    if (!t->lt_name) break;
+    for (size_t c = 0; c < RLE_LAT_CLASSES; ++c) {
+      const lat_hist_t* hist = &t->lt_hists[c];
+      if (hist->lh_count == 0) continue;
+
+      printf("[LAT] %-10s ", t->lt_name);
+      if (c == RLE_LAT_CLASSES - 1) {
+        printf("%4lu+     ", 1ul << (2 * c));
+      } else {
+        printf("%4lu-%-4lu ", 1ul << (2 * c), (1ul << (2 * c + 2)) - 1);
+      }
+      printf(
+          "%6lu requests, mean %lu, p50 %lu, p90 %lu, p99 %lu, "
+          "max %lu cycles\n",
+          hist->lh_count, (uint32_t)(hist->lh_sum / hist->lh_count),
+          lat_hist_percentile(hist, 500), lat_hist_percentile(hist, 900),
+          lat_hist_percentile(hist, 990), hist->lh_max);
+    }
+  }
+}
+
+void run_text_rle_timed(const char* data, void* ctx, on_encoded_t callback) {
+  static rle_rec_buf_t recs;
+  size_t len = strlen(data);
+
+  rle_rec_buf_reset(&recs);
+  set_rle_link_quiet(&rle_link, 1);
+  uint32_t start = rv32_csr_read(CSR_MCYCLE);
+  run_text_rle_chan(&rle_link, data, len, &recs, rle_rec_buf_push);
+  uint32_t cycles = rv32_csr_read(CSR_MCYCLE) - start;
+  set_rle_link_quiet(&rle_link, 0);
+  rle_rec_buf_replay(&recs, ctx, callback);
+
+  rle_lat_record(rle_link.l_name, len, cycles);
+}
+
+#endif /* RLE_LATENCY */
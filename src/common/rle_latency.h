@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_LATENCY_H_
+#define COMMON_RLE_LATENCY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/rle_link.h"
+
+/* Request latency (LATENCY=yes).
+ *
+ * Latency is measured from handing the input to the transport until the last
+ * record has been received, in cycles. Records are only formatted and printed
+ * after that. Histograms (common/lat_hist.h) are kept per transport and per
+ * input size class (1-3, 4-15, 16-63, 64-255 and 256+ symbols), so that the
+ * tail added by timeouts and interrupt handling isn't hidden in an
+ * average. */
+
+void rle_lat_record(const char* transport, size_t len, uint32_t cycles);
+
+void rle_lat_reset(void);
+
+/* Prints every non-empty histogram */
+void rle_lat_print(void);
+
+/* Encodes a request over `rle_link` and records its latency. Records are
+ * passed on once the request has been timed and transfers aren't reported,
+ * as with DMA=hybrid (common/rle_hybrid.h). */
+void run_text_rle_timed(const char* data, void* ctx, on_encoded_t callback);
+
+#endif /* COMMON_RLE_LATENCY_H_ */
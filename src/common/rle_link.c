@@ -0,0 +1,537 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_link.h"
+
+#include <stdio.h>
+
+#include "common/fmt.h"
+#include "common/mmio.h"
+#include "common/rle_print.h"
+#include "common/sections.h"
+#include "xls/xls_dma_man.h"
+#include "xls/xls_dma_ring.h"
+
+XLS_DMA_POOL_DEFINE(dma_buf_pool, DMA_POOL_BLOCK_SIZE, DMA_POOL_BLOCKS,
+                    DMA_POOL_ALIGN, DMA_BUF);
+
+size_t rle_chunk_len = DMATSFR_BUF_LEN;
+
+#ifdef RLE_BENCH
+uint32_t bench_bytes_moved;
+#endif
+
+#ifdef MMIO_STATS
+uint32_t rle_mmio_chunks;
+static mmio_totals_t mmio_request_start;
+
+void rle_mmio_request_begin(void) {
+  mmio_request_start = mmio_totals[MMIO_DEV_XLS];
+  rle_mmio_chunks    = 0;
+}
+
+void rle_mmio_request_end(size_t symbols) {
+  uint32_t reads  = mmio_totals[MMIO_DEV_XLS].mt_reads -
+                   mmio_request_start.mt_reads;
+  uint32_t writes = mmio_totals[MMIO_DEV_XLS].mt_writes -
+                    mmio_request_start.mt_writes;
+  uint32_t ops    = reads + writes;
+  if (!symbols) return;
+
+  printf("[MMIO] %lu reads, %lu writes, %lu.%02lu ops/symbol", reads, writes,
+         ops / symbols, (ops % symbols) * 100 / symbols);
+  if (rle_mmio_chunks) {
+    printf(", %lu chunks, %lu ops/chunk", rle_mmio_chunks,
+           ops / rle_mmio_chunks);
+  }
+  printf("\n");
+}
+#endif /* MMIO_STATS */
+
+void print_tsfr_error(int code) {
+  if (code == XLS_DMA_OK) {
+    printf("DMA procedure succeded\n");
+    return;
+  }
+  printf("DMA procedure failed with code %s", xls_dma_err_name(code));
+}
+
+FAST_TEXT void prepare_dma_input_buf(rle_enc_in_data_t* buf, const char* data,
+                                     size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    buf[i].e_sym = (rle_sym_t)data[i];
+#ifndef RLE_DMA_AXI
+    buf[i].e_last = (i == count - 1);
+#endif
+  }
+}
+
+#ifdef RLE_DMA
+static void complete_transfer(xls_dma_tsfr_t* tsfr) {
+#ifndef TRACE_ENABLED
+  uint32_t count = tsfr->tsfr_transferred_bytes;
+  const char* tsfr_name = (const char*)tsfr->tsfr_ctx;
+  printf("DMA transfer \"%s\" complete. Transferred %ld bytes\n",
+         tsfr_name, count);
+#endif
+}
+#endif /* RLE_DMA */
+
+#ifndef RLE_DMA_AXI
+int rle_out_is_last(const void* rec) {
+  return ((const rle_enc_out_data_t*)rec)->e_last;
+}
+#endif
+
+#ifdef RLE_STREAM
+int open_rle_stream_link(rle_link_t* link) {
+  int err;
+  if ((err = xls_chan_open_stream(&link->l_in,
+                                  &rle0_io.io_input_r->s_stream,
+                                  sizeof(rle_enc_in_data_t),
+                                  XLS_TSFR_TO_PERIPHERAL)) ||
+      (err = xls_chan_open_stream(&link->l_out,
+                                  &rle0_io.io_output_s->s_stream,
+                                  sizeof(rle_enc_out_data_t),
+                                  XLS_TSFR_FROM_PERIPHERAL))) {
+    return err;
+  }
+  xls_chan_end_on(&link->l_out, sizeof(rle_enc_out_data_t), rle_out_is_last);
+  return XLS_DMA_OK;
+}
+#endif /* RLE_STREAM */
+
+#ifdef RLE_DMA
+/* Encoder channels, allocated by direction at startup */
+static uint64_t rle_rd_chan;
+static uint64_t rle_wr_chan;
+
+int alloc_rle_dma_chans(void) {
+  int err;
+  if ((err = xls_dma_man_init(&rle0_dma_man, rle0_dma)) ||
+      (err = xls_dma_man_alloc(&rle0_dma_man, XLS_TSFR_TO_PERIPHERAL,
+                               &rle_rd_chan)) ||
+      (err = xls_dma_man_alloc(&rle0_dma_man, XLS_TSFR_FROM_PERIPHERAL,
+                               &rle_wr_chan))) {
+    print_tsfr_error(err);
+  }
+  return err;
+}
+
+static int open_rle_dma_link_man(rle_link_t* link, xls_dma_man_t* dma_man) {
+  int err;
+  if ((err = xls_chan_open_dma(&link->l_in, rle0_dma, rle_rd_chan,
+                               XLS_TSFR_TO_PERIPHERAL, dma_man,
+                               RLE_LINK_TLAST)) ||
+      (err = xls_chan_open_dma(&link->l_out, rle0_dma, rle_wr_chan,
+                               XLS_TSFR_FROM_PERIPHERAL, dma_man,
+                               RLE_LINK_TLAST))) {
+    return err;
+  }
+#ifndef RLE_DMA_AXI
+  xls_chan_end_on(&link->l_out, sizeof(rle_enc_out_data_t), rle_out_is_last);
+#endif
+  if (!link->l_quiet) {
+    xls_chan_on_complete(&link->l_in, &complete_transfer, "SIM->XLS");
+    xls_chan_on_complete(&link->l_out, &complete_transfer, "XLS->SIM");
+  }
+  return XLS_DMA_OK;
+}
+
+static int open_rle_dma_link(rle_link_t* link) {
+  return open_rle_dma_link_man(link, NULL);
+}
+
+#ifdef RLE_DMA_IRQ
+#ifndef RLE_DMA_IRQ_EVERY
+#define RLE_DMA_IRQ_EVERY 1
+#endif
+
+/* Only every RLE_DMA_IRQ_EVERY-th chunk and the last chunk of a request
+ * interrupt, the others are reaped by polling while waiting for them. On AXI
+ * DMA the output of a chunk ends with TLAST, which still interrupts. The
+ * input is never ended by the peripheral. */
+static int open_rle_dma_irq_link(rle_link_t* link) {
+  int err;
+  if ((err = open_rle_dma_link_man(link, &rle0_dma_man))) {
+    return err;
+  }
+  xls_chan_coalesce(&link->l_in, RLE_DMA_IRQ_EVERY, 0);
+  xls_chan_coalesce(&link->l_out, RLE_DMA_IRQ_EVERY, RLE_LINK_TLAST);
+  return XLS_DMA_OK;
+}
+#endif /* RLE_DMA_IRQ */
+#endif /* RLE_DMA */
+
+/* The last entry is the default one */
+const rle_link_desc_t rle_links[] = {
+#ifdef RLE_STREAM
+    {"stream", open_rle_stream_link},
+#endif
+#if defined(RLE_DMA_AXI)
+    {"axidma", open_rle_dma_link},
+#elif defined(RLE_DMA)
+    {"dma", open_rle_dma_link},
+#endif
+#if defined(RLE_DMA_AXI) && defined(RLE_DMA_IRQ)
+    {"axidma-irq", open_rle_dma_irq_link},
+#elif defined(RLE_DMA_IRQ)
+    {"dma-irq", open_rle_dma_irq_link},
+#endif
+};
+
+const size_t rle_link_cnt = sizeof(rle_links) / sizeof(rle_links[0]);
+
+rle_link_t rle_link;
+
+int open_rle_link(const rle_link_desc_t* desc) {
+  if (rle_link.l_name) {
+    xls_chan_close(&rle_link.l_in);
+    xls_chan_close(&rle_link.l_out);
+    rle_link.l_name = NULL;
+  }
+
+  int err;
+  if ((err = desc->ld_open(&rle_link))) {
+    print_tsfr_error(err);
+    return err;
+  }
+  rle_link.l_name = desc->ld_name;
+  return XLS_DMA_OK;
+}
+
+void set_rle_link_quiet(rle_link_t* link, int quiet) {
+  link->l_quiet = quiet;
+#ifdef RLE_DMA
+  xls_chan_on_complete(&link->l_in, quiet ? NULL : &complete_transfer,
+                       "SIM->XLS");
+  xls_chan_on_complete(&link->l_out, quiet ? NULL : &complete_transfer,
+                       "XLS->SIM");
+#endif
+}
+
+int submit_rle_chan(xls_chan_t* ch, void* data, size_t len) {
+  int err;
+  if ((err = xls_chan_submit(ch, data, len))) {
+    print_tsfr_error(err);
+  }
+  return err;
+}
+
+int complete_rle_chans(rle_link_t* link) {
+  int err = xls_chan_complete_pair(&link->l_in, &link->l_out,
+                                   RLE_TIMEOUT_CYCLES);
+  if (err == XLS_DMA_OK) {
+    return XLS_DMA_OK;
+  }
+  /* Output length isn't known beforehand, so the transfer is expected to
+   * time out, unless the peripheral marks the end of the output */
+  if (err == XLS_DMA_TIMEOUT && !link->l_out.ch_tlast) {
+    xls_chan_cancel(&link->l_out);
+    ++link->l_timeouts;
+    link->l_idle_cycles += link->l_out.ch_idle_cycles;
+    if (!link->l_quiet && !xls_chan_is_stream(&link->l_out)) {
+      printf("DMA transfer \"%s\" timed out. Transferred %ld bytes\n",
+             "XLS->SIM", (uint32_t)xls_chan_transferred(&link->l_out));
+    }
+    return XLS_DMA_OK;
+  }
+  xls_chan_cancel(&link->l_in);
+  xls_chan_cancel(&link->l_out);
+  print_tsfr_error(err);
+  return err;
+}
+
+#ifdef RLE_RX_RING
+#ifndef RLE_RX_RING_SLOTS
+#define RLE_RX_RING_SLOTS 8
+#endif
+
+/* Slots are carved out of one pool block and hold whole records */
+#define RLE_RX_RING_SLOT_SIZE                                             \
+  (DMA_POOL_BLOCK_SIZE / RLE_RX_RING_SLOTS / sizeof(rle_enc_out_data_t) * \
+   sizeof(rle_enc_out_data_t))
+
+typedef struct rle_ring_ctx {
+  xls_dma_ring_t* rr_ring;
+  on_encoded_t rr_callback;
+  void* rr_ctx;
+} rle_ring_ctx_t;
+
+/* Records are consumed straight from the slot, which is then re-armed */
+FAST_TEXT static void ring_slot_ready(void* ctx, uint8_t* data, size_t len) {
+  rle_ring_ctx_t* rr             = ctx;
+  const rle_enc_out_data_t* recs = (const rle_enc_out_data_t*)data;
+
+  for (size_t i = 0; i < len / sizeof(rle_enc_out_data_t); ++i) {
+    rr->rr_callback(rr->rr_ctx, recs[i]);
+  }
+  xls_dma_ring_release(rr->rr_ring);
+}
+
+#ifdef RLE_DMA_IRQ
+static int queue_rle_input(rle_link_t* link, xls_dma_tsfr_t* tsfr,
+                           rle_enc_in_data_t* buf, size_t len,
+                           xls_dma_handle_t* handle) {
+  // clang-format off
+  *tsfr = (xls_dma_tsfr_t){
+      .tsfr_chan         = link->l_in.ch_sess.sess_chan,
+      .tsfr_data         = buf,
+      .tsfr_len          = len * sizeof(rle_enc_in_data_t),
+      .tsfr_ignore       = 0,
+      .tsfr_dir          = XLS_TSFR_TO_PERIPHERAL,
+      .tsfr_ctx          = "SIM->XLS",
+      .tsfr_callback_isr = link->l_quiet ? NULL : &complete_transfer,
+  };
+  // clang-format on
+  int err = xls_dma_man_submit(link->l_in.ch_sess.sess_dma_man, tsfr, handle);
+  if (err) print_tsfr_error(err);
+  return err;
+}
+
+/* Both input buffers are kept queued on the input channel through the DMA
+ * manager. The ISR starts the next chunk as soon as the previous one is done
+ * and the firmware only refills the buffer that has been sent. */
+static void send_rle_ring_input(rle_link_t* link, xls_dma_ring_t* ring,
+                                rle_enc_in_data_t* in_buf[2],
+                                const char* data, size_t remaining) {
+  xls_dma_tsfr_t tsfrs[2];
+  xls_dma_handle_t handles[2];
+  size_t sent   = 0;
+  int cur       = 0; /* Buffer of the oldest chunk in flight */
+  int in_flight = 0;
+
+  while (sent < remaining || in_flight) {
+    while (in_flight < 2 && sent < remaining) {
+      int buf    = cur ^ in_flight;
+      size_t len = MIN(remaining - sent, rle_chunk_len);
+      prepare_dma_input_buf(in_buf[buf], data + sent, len);
+      if (queue_rle_input(link, &tsfrs[buf], in_buf[buf], len,
+                          &handles[buf])) {
+        remaining = sent;
+        break;
+      }
+      sent += len;
+      ++in_flight;
+    }
+    if (!in_flight) break;
+
+    int err;
+    while ((err = xls_dma_test(handles[cur])) == XLS_DMA_PENDING) {
+      xls_dma_ring_poll(ring);
+    }
+    --in_flight;
+    if (err) {
+      print_tsfr_error(err);
+      break;
+    }
+    BENCH_COUNT_BYTES(tsfrs[cur].tsfr_transferred_bytes);
+    MMIO_COUNT_CHUNK();
+    cur ^= 1;
+  }
+
+  /* Drops the chunk still queued after an error */
+  for (; in_flight; --in_flight) {
+    cur ^= 1;
+    xls_dma_cancel(handles[cur]);
+  }
+  xls_dma_session_sync(&link->l_in.ch_sess);
+}
+#else  /* RLE_DMA_IRQ */
+/* Input is double-buffered: the next chunk is packed while the current one
+ * is being transferred */
+static void send_rle_ring_input(rle_link_t* link, xls_dma_ring_t* ring,
+                                rle_enc_in_data_t* in_buf[2],
+                                const char* data, size_t remaining) {
+  int cur           = 0;
+  uint64_t tsfr_len = MIN(remaining, rle_chunk_len);
+  if (tsfr_len) {
+    prepare_dma_input_buf(in_buf[cur], data, tsfr_len);
+  }
+
+  while (remaining) {
+    xls_chan_set_final(&link->l_in, tsfr_len == remaining);
+    if (submit_rle_chan(&link->l_in, in_buf[cur],
+                        tsfr_len * sizeof(rle_enc_in_data_t))) {
+      break;
+    }
+
+    uint64_t next_len = MIN(remaining - tsfr_len, rle_chunk_len);
+    if (next_len) {
+      prepare_dma_input_buf(in_buf[cur ^ 1], data + tsfr_len, next_len);
+    }
+
+    int err;
+    while ((err = xls_chan_test(&link->l_in)) == XLS_DMA_PENDING) {
+      xls_dma_ring_poll(ring);
+    }
+    if (err) {
+      print_tsfr_error(err);
+      break;
+    }
+    BENCH_COUNT_BYTES(xls_chan_transferred(&link->l_in));
+    MMIO_COUNT_CHUNK();
+
+    data += tsfr_len;
+    remaining -= tsfr_len;
+    tsfr_len = next_len;
+    cur ^= 1;
+  }
+}
+#endif /* RLE_DMA_IRQ */
+
+/* Receive ring variant of `run_text_rle_chan`. The output channel writes
+ * into a ring of slots for the whole request instead of being armed per
+ * chunk, so the encoder is never stalled waiting for the output to be
+ * re-armed and records are consumed while the input is still being fed. */
+static void run_text_rle_ring(rle_link_t* link, const char* data,
+                              size_t remaining, void* ctx,
+                              on_encoded_t callback) {
+  rle_enc_in_data_t* in_buf[2] = {xls_dma_pool_alloc(&dma_buf_pool),
+                                  xls_dma_pool_alloc(&dma_buf_pool)};
+  uint8_t* ring_mem            = xls_dma_pool_alloc(&dma_buf_pool);
+  xls_dma_ring_t ring;
+  rle_ring_ctx_t rr = {&ring, callback, ctx};
+  int err           = XLS_DMA_NOMEM;
+
+  if (!in_buf[0] || !in_buf[1] || !ring_mem ||
+      (err = xls_dma_ring_init(&ring, &link->l_out.ch_sess, ring_mem,
+                               RLE_RX_RING_SLOT_SIZE, RLE_RX_RING_SLOTS,
+                               &ring_slot_ready, &rr, &link->l_out.ch_tsfr)) ||
+      (err = xls_dma_ring_start(&ring))) {
+    print_tsfr_error(err);
+  } else {
+    send_rle_ring_input(link, &ring, in_buf, data, remaining);
+
+    /* Output length isn't known beforehand, the ring is stopped once the
+     * encoder goes quiet */
+    xls_dma_ring_stop(&ring, RLE_TIMEOUT_CYCLES);
+    BENCH_COUNT_BYTES(ring.ring_bytes);
+    if (!link->l_quiet) {
+      printf(
+          "DMA ring \"%s\": %ld bytes in %ld transfers, %ld wrapped, "
+          "%ld with progress seen in flight\n",
+          "XLS->SIM", (uint32_t)ring.ring_bytes, ring.ring_tsfrs,
+          ring.ring_wraps, ring.ring_live_tsfrs);
+    }
+  }
+
+  if (in_buf[0]) xls_dma_pool_free(&dma_buf_pool, in_buf[0]);
+  if (in_buf[1]) xls_dma_pool_free(&dma_buf_pool, in_buf[1]);
+  if (ring_mem) xls_dma_pool_free(&dma_buf_pool, ring_mem);
+}
+#endif /* RLE_RX_RING */
+
+/* Input is double-buffered: the next chunk is packed while the current one
+ * is being transferred. */
+void run_text_rle_chan(rle_link_t* link, const char* data, size_t remaining,
+                       void* ctx, on_encoded_t callback) {
+#ifdef RLE_RX_RING
+  if (!xls_chan_is_stream(&link->l_out)) {
+    run_text_rle_ring(link, data, remaining, ctx, callback);
+    return;
+  }
+#endif
+  rle_enc_in_data_t* in_buf[2] = {xls_dma_pool_alloc(&dma_buf_pool),
+                                  xls_dma_pool_alloc(&dma_buf_pool)};
+  rle_enc_out_data_t* out_buf  = xls_dma_pool_alloc(&dma_buf_pool);
+  if (!in_buf[0] || !in_buf[1] || !out_buf) {
+    print_tsfr_error(XLS_DMA_NOMEM);
+    remaining = 0;
+  }
+
+  int cur           = 0;
+  uint64_t tsfr_len = MIN(remaining, rle_chunk_len);
+  if (tsfr_len) {
+    prepare_dma_input_buf(in_buf[cur], data, tsfr_len);
+  }
+
+  while (remaining) {
+    xls_chan_set_final(&link->l_in, tsfr_len == remaining);
+    xls_chan_set_final(&link->l_out, tsfr_len == remaining);
+
+    /* Arm the output first, so that the encoder can be drained while the
+     * input is still being fed */
+    if (submit_rle_chan(&link->l_out, out_buf,
+                        tsfr_len * sizeof(rle_enc_out_data_t))) {
+      break;
+    }
+    if (submit_rle_chan(&link->l_in, in_buf[cur],
+                        tsfr_len * sizeof(rle_enc_in_data_t))) {
+      xls_chan_cancel(&link->l_out);
+      break;
+    }
+
+    /* Overlap packing of the next chunk with the transfers in flight */
+    uint64_t next_len = MIN(remaining - tsfr_len, rle_chunk_len);
+    if (next_len) {
+      prepare_dma_input_buf(in_buf[cur ^ 1], data + tsfr_len, next_len);
+    }
+
+    if (complete_rle_chans(link)) {
+      break;
+    }
+    BENCH_COUNT_BYTES(xls_chan_transferred(&link->l_in) +
+                      xls_chan_transferred(&link->l_out));
+    MMIO_COUNT_CHUNK();
+
+    size_t records =
+        xls_chan_transferred(&link->l_out) / sizeof(rle_enc_out_data_t);
+    for (size_t i = 0; i < records; ++i) {
+      callback(ctx, out_buf[i]);
+#ifndef RLE_DMA_AXI
+      if (out_buf[i].e_last) break;
+#endif
+    }
+
+    data += tsfr_len;
+    remaining -= tsfr_len;
+    tsfr_len = next_len;
+    cur ^= 1;
+  }
+
+  if (in_buf[0]) xls_dma_pool_free(&dma_buf_pool, in_buf[0]);
+  if (in_buf[1]) xls_dma_pool_free(&dma_buf_pool, in_buf[1]);
+  if (out_buf) xls_dma_pool_free(&dma_buf_pool, out_buf);
+}
+
+void rle_rec_buf_reset(rle_rec_buf_t* buf) {
+  buf->rb_cnt     = 0;
+  buf->rb_dropped = 0;
+}
+
+void rle_rec_buf_push(void* ctx, rle_enc_out_data_t rec) {
+  rle_rec_buf_t* buf = (rle_rec_buf_t*)ctx;
+  if (buf->rb_cnt < RLE_REC_BUF_LEN) {
+    buf->rb_recs[buf->rb_cnt++] = rec;
+  } else {
+    ++buf->rb_dropped;
+  }
+}
+
+void rle_rec_buf_replay(const rle_rec_buf_t* buf, void* ctx,
+                        on_encoded_t callback) {
+  for (size_t i = 0; i < buf->rb_cnt; ++i) {
+    callback(ctx, buf->rb_recs[i]);
+  }
+  if (buf->rb_dropped) {
+    fmt_flush(&rec_fmt);
+    printf("[ERROR] %u records dropped, the record buffer holds %u\n",
+           buf->rb_dropped, RLE_REC_BUF_LEN);
+  }
+}
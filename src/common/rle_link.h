@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_LINK_H_
+#define COMMON_RLE_LINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dev/rle.h"
+#include "xls/xls_chan.h"
+#include "xls/xls_dma_pool.h"
+
+/* Encoder links.
+ *
+ * A link is the pair of channels (see xls/xls_chan.h) carrying the encoder
+ * input and output over one transport. The transports built into the
+ * firmware are listed in `rle_links`, the last one being the default, and
+ * `rle_link` holds the one in use, which can be switched at runtime. Every
+ * mode moves encoder data through `rle_link`, with DMA staging buffers taken
+ * from `dma_buf_pool`. */
+
+typedef void (*on_encoded_t)(void*, rle_enc_out_data_t);
+
+static const size_t RLE_TIMEOUT_CYCLES = 10000;
+
+#ifndef MIN
+#define MIN(a, b) (((a) <= (b)) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) (((a) >= (b)) ? (a) : (b))
+#endif
+
+/* Longest request read from the console */
+#define INPUT_BUF_STRLEN 256
+
+/* Largest DMA chunk in symbols, which sets the size of the pool blocks */
+#ifndef DMATSFR_BUF_LEN
+#define DMATSFR_BUF_LEN 256
+#endif
+
+/* Number of DMA staging buffers and their alignment. A request needs two
+ * input buffers and one output buffer. */
+#ifndef DMA_POOL_BLOCKS
+#define DMA_POOL_BLOCKS 4
+#endif
+#ifndef DMA_POOL_ALIGN
+#define DMA_POOL_ALIGN 8
+#endif
+
+#define DMA_POOL_BLOCK_SIZE \
+  (DMATSFR_BUF_LEN * MAX(sizeof(rle_enc_in_data_t), sizeof(rle_enc_out_data_t)))
+
+#ifdef RLE_DMA_AXI
+#define RLE_LINK_TLAST 1
+#else
+#define RLE_LINK_TLAST 0
+#endif
+
+typedef struct rle_link {
+  const char* l_name;
+  xls_chan_t l_in;
+  xls_chan_t l_out;
+  int l_quiet;         /* Don't report transfers */
+  uint32_t l_timeouts; /* Chunks whose output ended on the idle timeout */
+  uint32_t l_idle_cycles; /* Cycles spent waiting for those timeouts */
+} rle_link_t;
+
+typedef struct rle_link_desc {
+  const char* ld_name;
+  int (*ld_open)(rle_link_t* link);
+} rle_link_desc_t;
+
+extern const rle_link_desc_t rle_links[];
+extern const size_t rle_link_cnt;
+extern rle_link_t rle_link;
+extern xls_dma_pool_t dma_buf_pool;
+
+/* Symbols per DMA chunk, up to DMATSFR_BUF_LEN. Picked on startup with
+ * AUTOTUNE=yes, see common/rle_tune.h. */
+extern size_t rle_chunk_len;
+
+#ifdef RLE_BENCH
+/* Payload bytes moved between the CPU and the encoder */
+extern uint32_t bench_bytes_moved;
+#define BENCH_COUNT_BYTES(n) (bench_bytes_moved += (n))
+#else
+#define BENCH_COUNT_BYTES(n)
+#endif
+
+#ifdef MMIO_STATS
+/* Encoder register accesses of a request are reported per symbol and per DMA
+ * chunk. UART accesses are counted separately. */
+extern uint32_t rle_mmio_chunks;
+void rle_mmio_request_begin(void);
+void rle_mmio_request_end(size_t symbols);
+
+#define MMIO_COUNT_CHUNK() (++rle_mmio_chunks)
+#define MMIO_REQUEST_BEGIN() rle_mmio_request_begin()
+#define MMIO_REQUEST_END(symbols) rle_mmio_request_end(symbols)
+#else
+#define MMIO_COUNT_CHUNK()
+#define MMIO_REQUEST_BEGIN()
+#define MMIO_REQUEST_END(symbols)
+#endif
+
+void print_tsfr_error(int code);
+
+/* Packs `count` symbols into encoder input records. Without AXI DMA the last
+ * record is marked with e_last. */
+void prepare_dma_input_buf(rle_enc_in_data_t* buf, const char* data,
+                           size_t count);
+
+#ifndef RLE_DMA_AXI
+/* Each chunk of input ends with e_last, so does its output */
+int rle_out_is_last(const void* rec);
+#endif
+
+#ifdef RLE_DMA
+/* Allocates the encoder DMA channels, once at startup */
+int alloc_rle_dma_chans(void);
+#endif
+#ifdef RLE_STREAM
+int open_rle_stream_link(rle_link_t* link);
+#endif
+
+/* Closes the channels of `rle_link` and opens the ones of `desc` */
+int open_rle_link(const rle_link_desc_t* desc);
+
+/* Transfers aren't reported one by one */
+void set_rle_link_quiet(rle_link_t* link, int quiet);
+
+int submit_rle_chan(xls_chan_t* ch, void* data, size_t len);
+
+/* Waits for the input to be consumed and for the output. Output that ends on
+ * the idle timeout instead of e_last is counted in `l_timeouts`. */
+int complete_rle_chans(rle_link_t* link);
+
+/* Encodes `remaining` symbols in chunks of `rle_chunk_len` */
+void run_text_rle_chan(rle_link_t* link, const char* data, size_t remaining,
+                       void* ctx, on_encoded_t callback);
+
+/* Records of a request, collected while it's timed and passed on after. The
+ * encoder emits at most one record per symbol, so a buffer as long as the
+ * input line holds the records of any request. Records that don't fit are
+ * dropped and reported on replay. */
+#define RLE_REC_BUF_LEN INPUT_BUF_STRLEN
+
+typedef struct rle_rec_buf {
+  rle_enc_out_data_t rb_recs[RLE_REC_BUF_LEN];
+  size_t rb_cnt;
+  size_t rb_dropped;
+} rle_rec_buf_t;
+
+void rle_rec_buf_reset(rle_rec_buf_t* buf);
+
+/* Has the signature of `on_encoded_t`, `buf` is a `rle_rec_buf_t*` */
+void rle_rec_buf_push(void* buf, rle_enc_out_data_t rec);
+
+void rle_rec_buf_replay(const rle_rec_buf_t* buf, void* ctx,
+                        on_encoded_t callback);
+
+#endif /* COMMON_RLE_LINK_H_ */
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_pipeline.h"
+
+#ifdef RLE_PIPELINE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/fmt.h"
+#include "common/rle_coalesce.h"
+#include "common/rle_link.h"
+#include "common/rle_print.h"
+#include "common/sched.h"
+#ifdef DEV_LITEUART
+#include "dev/liteuart.h"
+#endif
+#ifdef DEV_SIMPLEUART
+#include "dev/simpleuart.h"
+#endif
+
+#define PIPE_LINE_CNT 4
+#define PIPE_TX_BUF_LEN 1024 /* Must be a power of two */
+#define PIPE_REC_MAX_LEN (REC_FMT_MAX_LEN + 1) /* A record with "\r\n" */
+
+static char pipe_lines[PIPE_LINE_CNT][INPUT_BUF_STRLEN + 1];
+static uint32_t pipe_lines_head; /* Next line to encode */
+static uint32_t pipe_lines_tail; /* Next line to fill */
+
+static char pipe_tx_buf[PIPE_TX_BUF_LEN];
+static uint32_t pipe_tx_head;
+static uint32_t pipe_tx_tail;
+
+static inline size_t pipe_tx_space(void) {
+  return PIPE_TX_BUF_LEN - (pipe_tx_head - pipe_tx_tail);
+}
+
+/* Expands "\n" into "\r\n", needs up to twice `len` bytes of space */
+static void pipe_tx_write(const char* str, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    if (str[i] == '\n') {
+      pipe_tx_buf[pipe_tx_head++ & (PIPE_TX_BUF_LEN - 1)] = '\r';
+    }
+    pipe_tx_buf[pipe_tx_head++ & (PIPE_TX_BUF_LEN - 1)] = str[i];
+  }
+}
+
+#ifdef RLE_COALESCE
+static void pipe_print_encoded_run(void* ctx, rle_run_t run) {
+  char buf[REC_FMT_MAX_LEN];
+  fmt_buf_t fmt;
+  fmt_init(&fmt, buf, sizeof(buf));
+  fmt_record(&fmt, run.r_sym, run.r_count, run.r_last);
+  pipe_tx_write(buf, fmt.f_len);
+}
+#else  /* RLE_COALESCE */
+static void pipe_print_encoded_sym(void* ctx, rle_enc_out_data_t sym) {
+  char buf[REC_FMT_MAX_LEN];
+  fmt_buf_t fmt;
+  fmt_init(&fmt, buf, sizeof(buf));
+#ifdef RLE_DMA_AXI
+  fmt_record(&fmt, sym.e_sym, sym.e_count, 0);
+#else  /* RLE_DMA_AXI */
+  fmt_record(&fmt, sym.e_sym, sym.e_count, sym.e_last);
+#endif /* RLE_DMA_AXI */
+  pipe_tx_write(buf, fmt.f_len);
+}
+#endif /* RLE_COALESCE */
+
+typedef struct pipe_rx {
+  unsigned char rx_c;
+  size_t rx_len;
+} pipe_rx_t;
+
+static int pipe_rx_task(sched_task_t* t) {
+  pipe_rx_t* rx = (pipe_rx_t*)t->t_ctx;
+
+  TASK_BEGIN(t);
+  while (1) {
+    TASK_WAIT_UNTIL(t, pipe_lines_tail - pipe_lines_head < PIPE_LINE_CNT);
+    TASK_WAIT_UNTIL(t, uart_try_getc(&rx->rx_c));
+    TASK_WAIT_UNTIL(t, pipe_tx_space() >= 2);
+
+    char* line = pipe_lines[pipe_lines_tail % PIPE_LINE_CNT];
+    if (rx->rx_c == '\r' || rx->rx_c == '\n' || rx->rx_c == ' ') {
+      pipe_tx_write(rx->rx_c == ' ' ? " " : "\n", 1);
+      if (rx->rx_len) {
+        line[rx->rx_len] = '\0';
+        rx->rx_len       = 0;
+        ++pipe_lines_tail;
+      }
+      continue;
+    }
+    pipe_tx_write((const char*)&rx->rx_c, 1);
+    if (rx->rx_len < INPUT_BUF_STRLEN) {
+      line[rx->rx_len++] = rx->rx_c;
+    }
+  }
+  TASK_END(t);
+}
+
+typedef struct pipe_enc {
+  const char* enc_data; /* Remaining input of the current line */
+  on_encoded_t enc_callback;
+  void* enc_callback_ctx;
+#ifdef RLE_COALESCE
+  rle_coalesce_t enc_coalesce;
+#endif
+  rle_enc_in_data_t* enc_in_buf;
+  rle_enc_out_data_t* enc_out_buf;
+  size_t enc_len;     /* Symbols in the current chunk */
+  size_t enc_polls;   /* Output polls without progress */
+  size_t enc_rec;     /* Next output record to pass on */
+  size_t enc_rec_cnt; /* Number of output records in the current chunk */
+} pipe_enc_t;
+
+/* Feeds the input of the current chunk. The output is drained at the same
+ * time, as stream channels only move records while they're tested. */
+static int pipe_enc_in_done(void) {
+  xls_chan_test(&rle_link.l_out);
+  return xls_chan_test(&rle_link.l_in) != XLS_DMA_PENDING;
+}
+
+/* Polls the output of the current chunk, which ends with e_last (TLAST with
+ * AXI DMA). The transfer is only given up on after RLE_TIMEOUT_CYCLES polls
+ * without progress, if the encoder stalls. */
+static int pipe_enc_out_done(pipe_enc_t* enc) {
+  size_t done = xls_chan_transferred(&rle_link.l_out);
+  if (xls_chan_test(&rle_link.l_out) != XLS_DMA_PENDING) {
+    return 1;
+  }
+  if (xls_chan_transferred(&rle_link.l_out) != done) {
+    enc->enc_polls = 0;
+  }
+  return ++enc->enc_polls >= RLE_TIMEOUT_CYCLES;
+}
+
+static int pipe_enc_task(sched_task_t* t) {
+  pipe_enc_t* enc = (pipe_enc_t*)t->t_ctx;
+
+  TASK_BEGIN(t);
+  enc->enc_in_buf  = xls_dma_pool_alloc(&dma_buf_pool);
+  enc->enc_out_buf = xls_dma_pool_alloc(&dma_buf_pool);
+  if (!enc->enc_in_buf || !enc->enc_out_buf) {
+    print_tsfr_error(XLS_DMA_NOMEM);
+    return SCHED_DONE;
+  }
+
+  while (1) {
+    TASK_WAIT_UNTIL(t, pipe_lines_tail != pipe_lines_head);
+    enc->enc_data = pipe_lines[pipe_lines_head % PIPE_LINE_CNT];
+#ifdef RLE_COALESCE
+    rle_coalesce_init(&enc->enc_coalesce, pipe_print_encoded_run, NULL);
+#endif
+
+    while (*enc->enc_data) {
+      size_t remaining = strlen(enc->enc_data);
+      enc->enc_len     = MIN(remaining, DMATSFR_BUF_LEN);
+      prepare_dma_input_buf(enc->enc_in_buf, enc->enc_data, enc->enc_len);
+
+      xls_chan_set_final(&rle_link.l_in, enc->enc_len == remaining);
+      xls_chan_set_final(&rle_link.l_out, enc->enc_len == remaining);
+      if (submit_rle_chan(&rle_link.l_out, enc->enc_out_buf,
+                          enc->enc_len * sizeof(rle_enc_out_data_t))) {
+        break;
+      }
+      if (submit_rle_chan(&rle_link.l_in, enc->enc_in_buf,
+                          enc->enc_len * sizeof(rle_enc_in_data_t))) {
+        xls_chan_cancel(&rle_link.l_out);
+        break;
+      }
+
+      TASK_WAIT_UNTIL(t, pipe_enc_in_done());
+      enc->enc_polls = 0;
+      TASK_WAIT_UNTIL(t, pipe_enc_out_done(enc));
+      xls_chan_cancel(&rle_link.l_out);
+      BENCH_COUNT_BYTES(xls_chan_transferred(&rle_link.l_in) +
+                        xls_chan_transferred(&rle_link.l_out));
+
+      /* Only the records written by this chunk are passed on */
+      enc->enc_rec_cnt =
+          xls_chan_transferred(&rle_link.l_out) / sizeof(rle_enc_out_data_t);
+      for (enc->enc_rec = 0; enc->enc_rec < enc->enc_rec_cnt;) {
+        TASK_WAIT_UNTIL(t, pipe_tx_space() >= PIPE_REC_MAX_LEN);
+        rle_enc_out_data_t rec = enc->enc_out_buf[enc->enc_rec++];
+        enc->enc_callback(enc->enc_callback_ctx, rec);
+#ifndef RLE_DMA_AXI
+        if (rec.e_last) break;
+#endif
+      }
+
+      enc->enc_data += enc->enc_len;
+    }
+
+    TASK_WAIT_UNTIL(t, pipe_tx_space() >= PIPE_REC_MAX_LEN);
+#ifdef RLE_COALESCE
+    rle_coalesce_finish(&enc->enc_coalesce);
+#endif
+    pipe_tx_write("\n", 1);
+    ++pipe_lines_head;
+  }
+  TASK_END(t);
+}
+
+static int pipe_tx_task(sched_task_t* t) {
+  TASK_BEGIN(t);
+  while (1) {
+    TASK_WAIT_UNTIL(t, pipe_tx_tail != pipe_tx_head);
+    while (pipe_tx_tail != pipe_tx_head &&
+           uart_try_putc(pipe_tx_buf[pipe_tx_tail & (PIPE_TX_BUF_LEN - 1)])) {
+      ++pipe_tx_tail;
+    }
+    TASK_YIELD(t);
+  }
+  TASK_END(t);
+}
+
+void run_pipeline(void) {
+  static pipe_rx_t rx;
+  static pipe_enc_t enc;
+
+#ifdef RLE_COALESCE
+  enc.enc_callback     = rle_coalesce_push;
+  enc.enc_callback_ctx = &enc.enc_coalesce;
+#else
+  enc.enc_callback     = pipe_print_encoded_sym;
+  enc.enc_callback_ctx = NULL;
+#endif
+  /* Printing from the transfer callbacks would block the pipeline */
+  set_rle_link_quiet(&rle_link, 1);
+
+  sched_task_t tasks[] = {
+      {.t_fn = pipe_rx_task, .t_ctx = &rx, .t_name = "rx"},
+      {.t_fn = pipe_enc_task, .t_ctx = &enc, .t_name = "encode"},
+      {.t_fn = pipe_tx_task, .t_ctx = NULL, .t_name = "tx"},
+  };
+
+  printf("Enter RLE input:\n");
+  sched_run(tasks, sizeof(tasks) / sizeof(tasks[0]));
+}
+
+#endif /* RLE_PIPELINE */
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_PIPELINE_H_
+#define COMMON_RLE_PIPELINE_H_
+
+/* Pipelined mode (PIPELINE=yes).
+ *
+ * Receiving input, encoding and printing the results run as three tasks on
+ * the cooperative scheduler (common/sched.h), each yielding whenever its
+ * device or its queue isn't ready. This keeps the UART and the encoder busy
+ * at the same time instead of waiting for each stage in turn. Input words are
+ * separated with whitespace, as with `scanf`. */
+
+/* Runs the pipeline forever */
+void run_pipeline(void);
+
+#endif /* COMMON_RLE_PIPELINE_H_ */
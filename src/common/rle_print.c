@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_print.h"
+
+#define REC_FMT_BUF_LEN 256
+
+static char rec_fmt_mem[REC_FMT_BUF_LEN];
+fmt_buf_t rec_fmt = {rec_fmt_mem, sizeof(rec_fmt_mem), 0};
+
+void fmt_record(fmt_buf_t* fmt, rle_sym_t sym, uint32_t count, int last) {
+  fmt_char(fmt, '[');
+  if (sym >= ' ' && sym <= '~') {
+    fmt_char(fmt, (char)sym);
+  } else {
+    fmt_hex(fmt, sym, RLE_SYMBOL_WIDTH / 4);
+  }
+  fmt_str(fmt, ", ");
+  fmt_udec(fmt, count);
+  fmt_char(fmt, ']');
+  if (last) {
+    fmt_str(fmt, " (last)");
+  }
+  fmt_char(fmt, '\n');
+}
+
+void print_encoded_run(void* ctx, rle_run_t run) {
+  if (fmt_space(&rec_fmt) < REC_FMT_MAX_LEN) fmt_flush(&rec_fmt);
+  fmt_record(&rec_fmt, run.r_sym, run.r_count, run.r_last);
+}
+
+void print_encoded_sym(void* ctx, rle_enc_out_data_t sym) {
+  if (fmt_space(&rec_fmt) < REC_FMT_MAX_LEN) fmt_flush(&rec_fmt);
+#ifdef RLE_DMA_AXI
+  fmt_record(&rec_fmt, sym.e_sym, sym.e_count, 0);
+#else  /* RLE_DMA_AXI */
+  fmt_record(&rec_fmt, sym.e_sym, sym.e_count, sym.e_last);
+#endif /* RLE_DMA_AXI */
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_PRINT_H_
+#define COMMON_RLE_PRINT_H_
+
+#include <stdint.h>
+
+#include "common/fmt.h"
+#include "common/rle_coalesce.h"
+#include "dev/rle.h"
+
+/* Encoder output printing.
+ *
+ * Encoded records are formatted with the fixed-function formatter into
+ * `rec_fmt` and written out in bulk. The buffer must be flushed before
+ * printing diagnostics, so that they don't overtake the records. */
+
+/* Longest record: "[0x12345678, 4294967295] (last)\n" */
+#define REC_FMT_MAX_LEN 32
+
+extern fmt_buf_t rec_fmt;
+
+/* Printable symbols are shown as characters, others in hex */
+void fmt_record(fmt_buf_t* fmt, rle_sym_t sym, uint32_t count, int last);
+
+/* Has the signature of `on_run_t`, `ctx` is unused */
+void print_encoded_run(void* ctx, rle_run_t run);
+
+/* Has the signature of `on_encoded_t`, `ctx` is unused */
+void print_encoded_sym(void* ctx, rle_enc_out_data_t sym);
+
+#endif /* COMMON_RLE_PRINT_H_ */
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_roundtrip.h"
+
+#ifdef RLE_ROUNDTRIP
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cpu/riscv_csr.h"
+#include "dev/rle_dec.h"
+#include "xls/xls_dma_man.h"
+
+typedef struct roundtrip_stats {
+  uint32_t rt_symbols;
+  uint32_t rt_records;
+  uint32_t rt_mismatches;
+  uint32_t rt_cycles;
+  uint32_t rt_timeouts; /* Output transfers that ended on the idle timeout */
+} roundtrip_stats_t;
+
+/* Result of the last request, printed once its records are flushed */
+static roundtrip_stats_t roundtrip_last;
+/* Totals over all requests, for the end-to-end throughput */
+static uint64_t roundtrip_total_symbols;
+static uint64_t roundtrip_total_cycles;
+
+rle_link_t rle_dec_link;
+
+static uint32_t compare_decoded(const char* data, size_t len,
+                                rle_sym_t decoded, size_t idx) {
+  return idx >= len || decoded != (rle_sym_t)data[idx];
+}
+
+#ifndef RLE_DMA_AXI
+/* The decoder output of a chunk ends with the symbol marked with d_last */
+static int rle_dec_out_is_last(const void* rec) {
+  return ((const rle_dec_out_data_t*)rec)->d_last;
+}
+#endif
+
+int open_rle_dec_link(rle_link_t* link) {
+  int err;
+#ifdef RLE_DMA
+#ifdef RLE_DMA_IRQ
+  xls_dma_man_t* dma_man = &rle_dec0_dma_man;
+#else
+  xls_dma_man_t* dma_man = NULL;
+#endif
+  uint64_t rd_chan, wr_chan;
+  if ((err = xls_dma_man_init(&rle_dec0_dma_man, rle_dec0_dma)) ||
+      (err = xls_dma_man_alloc(&rle_dec0_dma_man, XLS_TSFR_TO_PERIPHERAL,
+                               &rd_chan)) ||
+      (err = xls_dma_man_alloc(&rle_dec0_dma_man, XLS_TSFR_FROM_PERIPHERAL,
+                               &wr_chan)) ||
+      (err = xls_chan_open_dma(&link->l_in, rle_dec0_dma, rd_chan,
+                               XLS_TSFR_TO_PERIPHERAL, dma_man,
+                               RLE_LINK_TLAST)) ||
+      (err = xls_chan_open_dma(&link->l_out, rle_dec0_dma, wr_chan,
+                               XLS_TSFR_FROM_PERIPHERAL, dma_man,
+                               RLE_LINK_TLAST))) {
+    print_tsfr_error(err);
+    return err;
+  }
+#else  /* RLE_DMA */
+  if ((err = xls_chan_open_stream(&link->l_in,
+                                  &rle_dec0_io.io_input_r->s_stream,
+                                  sizeof(rle_dec_in_data_t),
+                                  XLS_TSFR_TO_PERIPHERAL)) ||
+      (err = xls_chan_open_stream(&link->l_out,
+                                  &rle_dec0_io.io_output_s->s_stream,
+                                  sizeof(rle_dec_out_data_t),
+                                  XLS_TSFR_FROM_PERIPHERAL))) {
+    print_tsfr_error(err);
+    return err;
+  }
+#endif /* RLE_DMA */
+#ifndef RLE_DMA_AXI
+  xls_chan_end_on(&link->l_out, sizeof(rle_dec_out_data_t),
+                  rle_dec_out_is_last);
+#endif
+  link->l_name  = xls_chan_name(&link->l_in);
+  link->l_quiet = 1;
+  return XLS_DMA_OK;
+}
+
+/* Encodes and decodes a single chunk of up to DMATSFR_BUF_LEN symbols. The
+ * encoder output ends on e_last and the decoder output on d_last (on TLAST
+ * with AXI DMA), so neither waits for the idle timeout unless a peripheral
+ * stalls. */
+static int roundtrip_chunk(const char* data, size_t len, int final,
+                           rle_enc_in_data_t* in_buf,
+                           rle_enc_out_data_t* enc_buf,
+                           rle_dec_out_data_t* dec_buf, rle_rec_buf_t* recs,
+                           roundtrip_stats_t* stats) {
+  int err;
+
+  prepare_dma_input_buf(in_buf, data, len);
+  xls_chan_set_final(&rle_link.l_in, final);
+  xls_chan_set_final(&rle_link.l_out, final);
+  if ((err = submit_rle_chan(&rle_link.l_out, enc_buf,
+                             len * sizeof(rle_enc_out_data_t)))) {
+    return err;
+  }
+  if ((err = submit_rle_chan(&rle_link.l_in, in_buf,
+                             len * sizeof(rle_enc_in_data_t)))) {
+    xls_chan_cancel(&rle_link.l_out);
+    return err;
+  }
+  if ((err = complete_rle_chans(&rle_link))) return err;
+
+  /* The encoder output goes to the decoder as is */
+  size_t records =
+      xls_chan_transferred(&rle_link.l_out) / sizeof(rle_enc_out_data_t);
+  for (size_t i = 0; i < records; ++i) {
+    rle_rec_buf_push(recs, enc_buf[i]);
+  }
+
+  xls_chan_set_final(&rle_dec_link.l_in, final);
+  xls_chan_set_final(&rle_dec_link.l_out, final);
+  if ((err = submit_rle_chan(&rle_dec_link.l_out, dec_buf,
+                             len * sizeof(rle_dec_out_data_t)))) {
+    return err;
+  }
+  if ((err = submit_rle_chan(&rle_dec_link.l_in, enc_buf,
+                             records * sizeof(rle_dec_in_data_t)))) {
+    xls_chan_cancel(&rle_dec_link.l_out);
+    return err;
+  }
+  if ((err = complete_rle_chans(&rle_dec_link))) return err;
+  BENCH_COUNT_BYTES(xls_chan_transferred(&rle_link.l_in) +
+                    xls_chan_transferred(&rle_link.l_out) +
+                    xls_chan_transferred(&rle_dec_link.l_in) +
+                    xls_chan_transferred(&rle_dec_link.l_out));
+  MMIO_COUNT_CHUNK();
+
+  size_t decoded =
+      xls_chan_transferred(&rle_dec_link.l_out) / sizeof(rle_dec_out_data_t);
+  for (size_t i = 0; i < decoded; ++i) {
+    stats->rt_mismatches += compare_decoded(data, len, dec_buf[i].d_sym, i);
+  }
+  if (decoded < len) stats->rt_mismatches += len - decoded;
+  stats->rt_records += records;
+  return XLS_DMA_OK;
+}
+
+static void run_roundtrip_chunks(const char* data, rle_rec_buf_t* recs,
+                                 roundtrip_stats_t* stats) {
+  size_t remaining = strlen(data);
+
+  rle_enc_in_data_t* in_buf   = xls_dma_pool_alloc(&dma_buf_pool);
+  rle_enc_out_data_t* enc_buf = xls_dma_pool_alloc(&dma_buf_pool);
+  rle_dec_out_data_t* dec_buf = xls_dma_pool_alloc(&dma_buf_pool);
+  if (!in_buf || !enc_buf || !dec_buf) {
+    print_tsfr_error(XLS_DMA_NOMEM);
+    stats->rt_mismatches += remaining;
+    remaining = 0;
+  }
+
+  while (remaining) {
+    size_t len = MIN(remaining, DMATSFR_BUF_LEN);
+    if (roundtrip_chunk(data, len, len == remaining, in_buf, enc_buf, dec_buf,
+                        recs, stats)) {
+      stats->rt_mismatches += remaining;
+      break;
+    }
+    data += len;
+    remaining -= len;
+  }
+
+  if (in_buf) xls_dma_pool_free(&dma_buf_pool, in_buf);
+  if (enc_buf) xls_dma_pool_free(&dma_buf_pool, enc_buf);
+  if (dec_buf) xls_dma_pool_free(&dma_buf_pool, dec_buf);
+}
+
+void run_roundtrip(const char* data, void* ctx, on_encoded_t callback) {
+  static rle_rec_buf_t recs;
+  roundtrip_stats_t stats = {.rt_symbols = strlen(data)};
+  uint32_t timeouts       = rle_link.l_timeouts + rle_dec_link.l_timeouts;
+
+  /* Records are printed once the round trip has been timed and transfers
+   * aren't reported */
+  rle_rec_buf_reset(&recs);
+  set_rle_link_quiet(&rle_link, 1);
+  uint32_t start = rv32_csr_read(CSR_MCYCLE);
+  run_roundtrip_chunks(data, &recs, &stats);
+  stats.rt_cycles = rv32_csr_read(CSR_MCYCLE) - start;
+  set_rle_link_quiet(&rle_link, 0);
+  stats.rt_timeouts =
+      rle_link.l_timeouts + rle_dec_link.l_timeouts - timeouts;
+  rle_rec_buf_replay(&recs, ctx, callback);
+
+  roundtrip_total_symbols += stats.rt_symbols;
+  roundtrip_total_cycles += stats.rt_cycles;
+  roundtrip_last = stats;
+}
+
+void print_roundtrip_stats(void) {
+  const roundtrip_stats_t* stats = &roundtrip_last;
+  uint32_t cycles                = stats->rt_cycles ? stats->rt_cycles : 1;
+  uint64_t total_cycles =
+      roundtrip_total_cycles ? roundtrip_total_cycles : 1;
+
+  printf("[ROUNDTRIP] %lu symbols, %lu records, ", stats->rt_symbols,
+         stats->rt_records);
+  if (stats->rt_mismatches) {
+    printf("FAILED (%lu mismatched symbols)", stats->rt_mismatches);
+  } else {
+    printf("OK");
+  }
+  printf(", %lu cycles, %lu symbols/s (%lu symbols/s overall)\n",
+         stats->rt_cycles,
+         (unsigned long)((uint64_t)stats->rt_symbols * CPU_FREQ_HZ / cycles),
+         (unsigned long)(roundtrip_total_symbols * CPU_FREQ_HZ /
+                         total_cycles));
+  /* Transfers that didn't end on e_last/d_last include the idle timeout */
+  if (stats->rt_timeouts) {
+    printf("[ROUNDTRIP] %lu transfers timed out, cycles include the waits\n",
+           stats->rt_timeouts);
+  }
+}
+
+#endif /* RLE_ROUNDTRIP */
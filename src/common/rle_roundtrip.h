@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_ROUNDTRIP_H_
+#define COMMON_RLE_ROUNDTRIP_H_
+
+#include "common/rle_link.h"
+
+/* Round-trip mode (ROUNDTRIP=yes).
+ *
+ * Every request is encoded, the encoder output is decoded and the decoded
+ * symbols are compared with the input. The buffer filled by the encoder's
+ * output channel is passed as is to the decoder's input channel. */
+
+/* Decoder channels, opened once at startup over the same kind of transport
+ * as the encoder's. Their transfers are never reported. */
+extern rle_link_t rle_dec_link;
+
+int open_rle_dec_link(rle_link_t* link);
+
+/* Has the signature of `run_text_rle_chan` without the link. Records are
+ * passed to `callback` once the round trip has been timed. */
+void run_roundtrip(const char* data, void* ctx, on_encoded_t callback);
+
+/* Result of the last request, once its records are flushed */
+void print_roundtrip_stats(void);
+
+#endif /* COMMON_RLE_ROUNDTRIP_H_ */
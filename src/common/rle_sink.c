@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_sink.h"
+
+#include "common/crc32.h"
+
+void rle_sink_init(rle_sink_t* sink, rle_sink_rec_t* buf, size_t cap) {
+  sink->s_buf     = buf;
+  sink->s_cap     = buf ? cap : 0;
+  sink->s_len     = 0;
+  sink->s_crc     = 0;
+  sink->s_records = 0;
+  sink->s_symbols = 0;
+}
+
+static void rle_sink_add(rle_sink_t* sink, uint32_t sym, uint32_t count) {
+  rle_sink_rec_t rec = {.sr_sym = sym, .sr_count = count};
+
+  sink->s_crc = crc32_update(sink->s_crc, &rec, sizeof(rec));
+  if (sink->s_len < sink->s_cap) {
+    sink->s_buf[sink->s_len++] = rec;
+  }
+  ++sink->s_records;
+  sink->s_symbols += count;
+}
+
+void rle_sink_push(void* ctx, rle_enc_out_data_t rec) {
+  rle_sink_add((rle_sink_t*)ctx, rec.e_sym, rec.e_count);
+}
+
+void rle_sink_push_run(void* ctx, rle_run_t run) {
+  rle_sink_add((rle_sink_t*)ctx, run.r_sym, run.r_count);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_SINK_H_
+#define COMMON_RLE_SINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/rle_coalesce.h"
+#include "dev/rle.h"
+
+/* Memory sink for encoder output.
+ *
+ * Instead of being printed, every record (or coalesced run) is reduced to
+ * a (symbol, count) pair of two little-endian 32-bit words, which is folded
+ * into a running CRC-32 and, if the sink has a buffer, appended to it. Once
+ * the buffer is full, further pairs only update the CRC and the counters.
+ * `last` markers are not included, so with coalescing the digest doesn't
+ * depend on how the input was split into transfers.
+ *
+ * The digest of an input can be computed on the host as the zlib CRC-32 of
+ * its runs packed with struct format "<II". */
+
+typedef struct rle_sink_rec {
+  uint32_t sr_sym;
+  uint32_t sr_count;
+} rle_sink_rec_t;
+
+typedef struct rle_sink {
+  rle_sink_rec_t* s_buf; /* NULL to discard the output */
+  size_t s_cap;          /* Capacity of `s_buf` in pairs */
+  size_t s_len;          /* Pairs stored in `s_buf` */
+  uint32_t s_crc;
+  uint32_t s_records; /* Pairs received */
+  uint32_t s_symbols; /* Sum of counts */
+} rle_sink_t;
+
+void rle_sink_init(rle_sink_t* sink, rle_sink_rec_t* buf, size_t cap);
+
+/* Has the signature of `on_encoded_t`, `sink` is a `rle_sink_t*` */
+void rle_sink_push(void* sink, rle_enc_out_data_t rec);
+
+/* Has the signature of `on_run_t`, `sink` is a `rle_sink_t*` */
+void rle_sink_push_run(void* sink, rle_run_t run);
+
+#endif /* COMMON_RLE_SINK_H_ */
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_tune.h"
+
+#ifdef RLE_AUTOTUNE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/rle_link.h"
+#include "cpu/riscv_csr.h"
+
+#ifndef RLE_TUNE_SYMS
+#define RLE_TUNE_SYMS 1024
+#endif
+#ifndef RLE_TUNE_REPS
+#define RLE_TUNE_REPS 3
+#endif
+#define RLE_TUNE_MIN_CHUNK 16
+#define RLE_TUNE_MAX_POINTS 16
+
+typedef struct rle_tune_point {
+  uint32_t tp_chunk;
+  uint32_t tp_cost; /* cycles/symbol * 100 */
+} rle_tune_point_t;
+
+static char rle_tune_input[RLE_TUNE_SYMS + 1];
+static rle_tune_point_t rle_tune_curve[RLE_TUNE_MAX_POINTS];
+static size_t rle_tune_points;
+
+static void rle_tune_discard(void* ctx, rle_enc_out_data_t rec) {}
+
+static void rle_tune_fill_input(void) {
+  uint32_t seed = 1;
+  size_t pos    = 0;
+  for (char sym = 'a'; pos < RLE_TUNE_SYMS; sym = sym == 'd' ? 'a' : sym + 1) {
+    seed       = seed * 1103515245 + 12345;
+    size_t run = MIN(((seed >> 16) & 0xf) + 1, RLE_TUNE_SYMS - pos);
+    memset(&rle_tune_input[pos], sym, run);
+    pos += run;
+  }
+  rle_tune_input[RLE_TUNE_SYMS] = '\0';
+}
+
+static uint32_t rle_tune_measure(size_t chunk) {
+  uint32_t best = UINT32_MAX;
+  rle_chunk_len = chunk;
+  for (size_t rep = 0; rep < RLE_TUNE_REPS; ++rep) {
+    rle_link.l_idle_cycles = 0;
+    uint32_t start         = rv32_csr_read(CSR_MCYCLE);
+    run_text_rle_chan(&rle_link, rle_tune_input, RLE_TUNE_SYMS, NULL,
+                      rle_tune_discard);
+    uint32_t cycles = rv32_csr_read(CSR_MCYCLE) - start;
+    best            = MIN(best, cycles - rle_link.l_idle_cycles);
+  }
+  return (uint64_t)best * 100 / RLE_TUNE_SYMS;
+}
+
+void rle_tune_chunk(void) {
+  if (!rle_tune_input[0]) rle_tune_fill_input();
+
+  set_rle_link_quiet(&rle_link, 1);
+  rle_tune_points = 0;
+  size_t best     = 0;
+  for (size_t chunk = RLE_TUNE_MIN_CHUNK;
+       rle_tune_points < RLE_TUNE_MAX_POINTS; chunk *= 2) {
+    chunk = MIN(chunk, DMATSFR_BUF_LEN);
+
+    rle_tune_point_t* point = &rle_tune_curve[rle_tune_points];
+    point->tp_chunk         = chunk;
+    point->tp_cost          = rle_tune_measure(chunk);
+    if (point->tp_cost < rle_tune_curve[best].tp_cost) {
+      best = rle_tune_points;
+    }
+    ++rle_tune_points;
+    if (chunk == DMATSFR_BUF_LEN) break;
+  }
+  set_rle_link_quiet(&rle_link, 0);
+
+  rle_chunk_len = rle_tune_curve[best].tp_chunk;
+  printf("[TUNE] %s: %u symbols per chunk\n", rle_link.l_name, rle_chunk_len);
+}
+
+void rle_tune_print(void) {
+  for (size_t i = 0; i < rle_tune_points; ++i) {
+    const rle_tune_point_t* point = &rle_tune_curve[i];
+    printf("[TUNE] %c %4lu: %lu.%02lu cycles/symbol\n",
+           point->tp_chunk == rle_chunk_len ? '*' : ' ', point->tp_chunk,
+           point->tp_cost / 100, point->tp_cost % 100);
+  }
+  printf("[TUNE] %s: %u symbols per chunk\n", rle_link.l_name, rle_chunk_len);
+}
+
+void rle_tune_set(const char* arg) {
+  char* end;
+  unsigned long chunk = strtoul(arg, &end, 10);
+  if (end != arg && !*end && chunk > 0 && chunk <= DMATSFR_BUF_LEN) {
+    rle_chunk_len = chunk;
+    printf("[TUNE] %s: %u symbols per chunk\n", rle_link.l_name,
+           rle_chunk_len);
+  } else {
+    printf("Chunk size must be between 1 and %u\n", DMATSFR_BUF_LEN);
+  }
+}
+
+#endif /* RLE_AUTOTUNE */
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_RLE_TUNE_H_
+#define COMMON_RLE_TUNE_H_
+
+/* DMA chunk size calibration (AUTOTUNE=yes).
+ *
+ * Each candidate chunk size, from RLE_TUNE_MIN_CHUNK doubling up to
+ * DMATSFR_BUF_LEN, encodes a synthetic request of RLE_TUNE_SYMS symbols (runs
+ * of 1-16 symbols) RLE_TUNE_REPS times over the current transport. The best
+ * run gives the cost of the candidate in cycles/symbol, and the cheapest
+ * candidate becomes `rle_chunk_len`. Chunks normally end on e_last, the idle
+ * wait of those that time out instead isn't counted, so the cost is that of
+ * the transport and not of the timeout. */
+
+/* Measures the candidates and picks the cheapest one */
+void rle_tune_chunk(void);
+
+/* Prints the measured curve and the chunk size in use */
+void rle_tune_print(void);
+
+/* Sets the chunk size from the argument of "/chunk=<n>" */
+void rle_tune_set(const char* arg);
+
+#endif /* COMMON_RLE_TUNE_H_ */
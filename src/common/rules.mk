@@ -4,6 +4,24 @@ OUTDIRS += $(OUTROOT)/common
 
 COMMON_SRCS = \
 	syscalls.c \
+	rle_coalesce.c \
+	sched.c \
+	fmt.c \
+	mmio.c \
+	trace.c \
+	crc32.c \
+	corpus.c \
+	rle_sink.c \
+	lat_hist.c \
+	rle_print.c \
+	rle_link.c \
+	rle_tune.c \
+	rle_latency.c \
+	rle_hybrid.c \
+	rle_batch.c \
+	rle_pipeline.c \
+	rle_roundtrip.c \
+	rle_irq_bench.c \
 	main.c
 
 OBJS += $(patsubst %.c,$(OUTROOT)/common/%.o,$(COMMON_SRCS))
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sched.h"
+
+void sched_run(sched_task_t* tasks, size_t cnt) {
+  size_t live;
+
+  do {
+    live = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+      sched_task_t* t = &tasks[i];
+      if (t->t_status == SCHED_DONE) continue;
+
+      t->t_status = t->t_fn(t);
+      ++t->t_runs;
+      if (t->t_status != SCHED_DONE) ++live;
+    }
+  } while (live);
+}
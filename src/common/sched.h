@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_SCHED_H_
+#define COMMON_SCHED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Cooperative run-to-completion scheduler with stackless tasks.
+ *
+ * A task is a function that is called repeatedly by `sched_run`. Using the
+ * TASK_* macros it can give up the CPU in the middle of its body and resume at
+ * the same point on the next call, e.g. when a device isn't ready yet. All
+ * tasks share a single stack, so local variables are NOT preserved across
+ * TASK_YIELD/TASK_WAIT_UNTIL. State that needs to survive has to be kept in
+ * `t_ctx`. TASK_* macros can't be used inside of a `switch` statement. */
+
+#define SCHED_YIELD 0
+#define SCHED_DONE 1
+
+struct sched_task;
+typedef int (*sched_task_fn_t)(struct sched_task*);
+
+typedef struct sched_task {
+  sched_task_fn_t t_fn; /* Task body */
+  void* t_ctx;          /* Task state */
+  const char* t_name;
+  uint32_t t_resume;    /* Resume point, 0 on first entry */
+  uint32_t t_status;    /* SCHED_YIELD or SCHED_DONE */
+  uint32_t t_runs;      /* Number of times the task has been called */
+} sched_task_t;
+
+#define TASK_BEGIN(t)       \
+  switch ((t)->t_resume) {  \
+    case 0:
+
+#define TASK_YIELD(t)             \
+  do {                            \
+    (t)->t_resume = __LINE__;     \
+    return SCHED_YIELD;           \
+    case __LINE__:;               \
+  } while (0)
+
+#define TASK_WAIT_UNTIL(t, cond)        \
+  do {                                  \
+    (t)->t_resume = __LINE__;           \
+    case __LINE__:                      \
+      if (!(cond)) return SCHED_YIELD;  \
+  } while (0)
+
+#define TASK_END(t)   \
+  }                   \
+  (t)->t_resume = 0;  \
+  return SCHED_DONE
+
+/* Calls the tasks in a round-robin fashion until all of them are done */
+void sched_run(sched_task_t* tasks, size_t cnt);
+
+#endif /* COMMON_SCHED_H_ */
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_SECTIONS_H_
+#define COMMON_SECTIONS_H_
+
+/* Placement of hot code and data in on-chip SRAM.
+ *
+ * `.fast_text` and `.fast_data` are linked to run from SRAM and are copied
+ * there from main RAM by `crt_init`. `.dma_buf` is not initialized at all.
+ * With FAST_MEM disabled the attributes expand to nothing and everything stays
+ * in main RAM, which allows comparing both layouts with the same sources. */
+
+#ifdef FAST_MEM
+#define FAST_TEXT __attribute__((section(".fast_text"), noinline))
+#define FAST_DATA __attribute__((section(".fast_data")))
+#define DMA_BUF __attribute__((section(".dma_buf")))
+#else
+#define FAST_TEXT
+#define FAST_DATA
+#define DMA_BUF
+#endif
+
+#endif /* COMMON_SECTIONS_H_ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "trace.h"
+
+#ifdef TRACE_ENABLED
+
+#include <stddef.h>
+
+#ifdef DEV_LITEUART
+#include "dev/liteuart.h"
+#endif
+#ifdef DEV_SIMPLEUART
+#include "dev/simpleuart.h"
+#endif
+
+trace_rec_t trace_ring[TRACE_RING_LEN];
+uint32_t trace_head;
+
+static void put_bytes(const void* data, size_t len) {
+  const unsigned char* ptr = (const unsigned char*)data;
+  while (len--) {
+    uart_putc(*ptr++);
+  }
+}
+
+static void put_u32(uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    uart_putc(value >> (8 * i));
+  }
+}
+
+void trace_dump(void) {
+  /* Snapshot the head, so that events recorded by ISRs while dumping don't
+   * mix with the dumped ones */
+  uint32_t irq_state = rv32_irq_save();
+  uint32_t head      = trace_head;
+  rv32_irq_restore(irq_state);
+
+  uint32_t cnt = head < TRACE_RING_LEN ? head : TRACE_RING_LEN;
+
+  put_bytes("XTRC", 4);
+  put_u32(head);
+  put_u32(cnt);
+  for (uint32_t i = head - cnt; i != head; ++i) {
+    put_bytes(&trace_ring[i & (TRACE_RING_LEN - 1)], sizeof(trace_rec_t));
+  }
+}
+
+void trace_reset(void) {
+  uint32_t irq_state = rv32_irq_save();
+  trace_head         = 0;
+  rv32_irq_restore(irq_state);
+}
+
+#endif /* TRACE_ENABLED */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMMON_TRACE_H_
+#define COMMON_TRACE_H_
+
+#include <stdint.h>
+
+/* Binary event trace.
+ *
+ * Events are stamped with `mcycle` and stored in a fixed-size ring, which
+ * keeps the most recent TRACE_RING_LEN events. Recording an event takes a few
+ * instructions and no I/O, unlike printing from the traced code. The ring is
+ * sent over the UART with `trace_dump` and converted into a Chrome/Perfetto
+ * trace with `scripts/trace2perfetto.py`.
+ *
+ * Without TRACE_ENABLED the TRACE_EVENT macro expands to nothing. */
+
+typedef enum trace_event {
+  TRACE_TSFR_BEGIN = 1, /* arg: length in bytes (saturated) */
+  TRACE_TSFR_COMPLETE,  /* arg: transferred bytes (saturated) */
+  TRACE_TSFR_CANCEL,
+  TRACE_ISR_ENTER,      /* arg: IRQ number or pending mask */
+  TRACE_ISR_EXIT,
+  TRACE_STREAM_WAIT_BEGIN,
+  TRACE_STREAM_WAIT_END,
+  TRACE_CALLBACK_BEGIN,
+  TRACE_CALLBACK_END,
+} trace_event_t;
+
+#define TRACE_CHAN_NONE 0xff
+
+typedef struct __attribute__((packed)) trace_rec {
+  uint32_t tr_cycle;
+  uint8_t tr_event;
+  uint8_t tr_chan;
+  uint16_t tr_arg;
+} trace_rec_t;
+
+#ifdef TRACE_ENABLED
+
+#include "cpu/riscv_csr.h"
+
+/* Must be a power of two */
+#ifndef TRACE_RING_LEN
+#define TRACE_RING_LEN 1024
+#endif
+
+extern trace_rec_t trace_ring[TRACE_RING_LEN];
+extern uint32_t trace_head;
+
+static inline void trace_event(uint8_t event, uint8_t chan, uint32_t arg) {
+  uint32_t cycle     = rv32_csr_read(CSR_MCYCLE);
+  uint32_t irq_state = rv32_irq_save();
+  trace_rec_t* rec   = &trace_ring[trace_head++ & (TRACE_RING_LEN - 1)];
+  rv32_irq_restore(irq_state);
+
+  rec->tr_cycle = cycle;
+  rec->tr_event = event;
+  rec->tr_chan  = chan;
+  rec->tr_arg   = arg > UINT16_MAX ? UINT16_MAX : arg;
+}
+
+#define TRACE_EVENT(event, chan, arg) trace_event((event), (chan), (arg))
+
+/* Sends the ring over the UART. The dump starts with the "XTRC" magic,
+ * followed by the total number of recorded events and the number of records
+ * in the dump (both little-endian uint32_t), and the records themselves,
+ * oldest first. */
+void trace_dump(void);
+void trace_reset(void);
+
+#else /* TRACE_ENABLED */
+
+#define TRACE_EVENT(event, chan, arg) \
+  do {                                \
+  } while (0)
+
+#endif /* TRACE_ENABLED */
+
+#endif /* COMMON_TRACE_H_ */
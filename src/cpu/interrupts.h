@@ -30,6 +30,16 @@ void interrupt_disable_external(uint32_t irq);
 uint32_t interrupt_priority_count(void);
 void interrupt_set_priority(uint32_t irq, uint32_t prio);
 
+/* Traps taken for external interrupts and IRQs serviced by them. A trap
+ * services every IRQ pending when it's taken, so under mixed load there are
+ * fewer traps than IRQs. */
+typedef struct interrupt_stats {
+  uint32_t is_traps;
+  uint32_t is_irqs;
+} interrupt_stats_t;
+
+void interrupt_get_stats(interrupt_stats_t *stats);
+
 void isr(uint32_t irq);
 
 #endif /* CPU_INTERRUPTS_H_ */
@@ -44,6 +44,7 @@ extern unsigned int _init_mbadaddr;
 #define CSR_MIP (0x344)
 #define CSR_MCYCLE (0xB00)
 #define CSR_MINSTRET (0xB02)
+#define CSR_MCYCLEH (0xB80)
 
 static inline uint32_t rv32_csr_read(uint32_t csr_num) {
   int result;
@@ -55,4 +56,34 @@ static inline void rv32_csr_write(uint32_t csr_num, uint32_t value) {
   asm volatile("csrw %0, %1" ::"i"(csr_num), "r"(value) : "memory");
 }
 
+/* Full 64-bit cycle counter, for measurements that can exceed 2^32 cycles.
+ * The high half is read twice to catch a carry out of the low one. */
+static inline uint64_t rv32_cycles64(void) {
+  uint32_t hi, lo;
+  do {
+    hi = rv32_csr_read(CSR_MCYCLEH);
+    lo = rv32_csr_read(CSR_MCYCLE);
+  } while (hi != rv32_csr_read(CSR_MCYCLEH));
+  return ((uint64_t)hi << 32) | lo;
+}
+
+#define CSR_MSTATUS_MIE (0x8)
+
+/* Disable machine interrupts and return the previous state of mstatus, to be
+ * passed to `rv32_irq_restore`. */
+static inline uint32_t rv32_irq_save(void) {
+  uint32_t mstatus;
+  asm volatile("csrrci %0, mstatus, %1"
+               : "=r"(mstatus)
+               : "i"(CSR_MSTATUS_MIE)
+               : "memory");
+  return mstatus;
+}
+
+static inline void rv32_irq_restore(uint32_t mstatus) {
+  if (mstatus & CSR_MSTATUS_MIE) {
+    asm volatile("csrsi mstatus, %0" ::"i"(CSR_MSTATUS_MIE) : "memory");
+  }
+}
+
 #endif /* CPU_RISCV_CSR_H_ */
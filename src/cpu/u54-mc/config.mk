@@ -1 +1,2 @@
-CPUFLAGS = -D__vexriscv__ -march=rv32imczicsr -mabi=ilp32
+MARCH ?= rv32imczicsr
+CPUFLAGS = -D__vexriscv__ -march=$(MARCH) -mabi=ilp32
@@ -19,6 +19,8 @@
 #include <stddef.h>
 
 #include "cpu/interrupts.h"
+#include "common/sections.h"
+#include "common/trace.h"
 #include "cpu/riscv_csr.h"
 
 #define U54_MC_PLIC_PRIORITY   0x0C000000
@@ -28,6 +30,11 @@
 #define U54_MC_PLIC_CLAIM      0x0C200004
 
 #define U54_MC_PLIC_BANK_COUNT 15
+#define U54_MC_PLIC_PRIO_MASK  0x7
+
+/* Enable bits are packed 32 IRQs per bank */
+#define U54_MC_PLIC_BANK(irq) ((irq) / 32)
+#define U54_MC_PLIC_BIT(irq)  ((uint32_t)1 << ((irq) % 32))
 
 static volatile uint32_t *u54mc_plic_priority =
   (volatile uint32_t *)U54_MC_PLIC_PRIORITY;
@@ -35,9 +42,11 @@ static volatile uint32_t *u54mc_plic_enable =
   (volatile uint32_t *)U54_MC_PLIC_ENABLE;
 static volatile uint32_t *u54cm_plic_threshold =
   (volatile uint32_t *)U54_MC_PLIC_THRESHOLD;
-static volatile uint32_t *u54mc_plic_claim =
+static volatile uint32_t *u54mc_plic_claim FAST_DATA =
   (volatile uint32_t *)U54_MC_PLIC_CLAIM;
 
+static volatile interrupt_stats_t u54mc_irq_stats FAST_DATA;
+
 void interrupt_init_external(void) {
   for (size_t bank = 0; bank < U54_MC_PLIC_BANK_COUNT; ++bank)
     u54mc_plic_enable[bank] = 0;
@@ -45,41 +54,65 @@ void interrupt_init_external(void) {
 }
 
 void interrupt_enable_external(uint32_t irq) {
-  size_t bank = 0;
-  while (irq >= 32) {
-    ++bank;
-    irq -= 32;
-  }
-  u54mc_plic_enable[bank] |= (uint32_t)1 << irq;
+  u54mc_plic_enable[U54_MC_PLIC_BANK(irq)] |= U54_MC_PLIC_BIT(irq);
 
   /* Priority `0` means that the interrupt is effectively disabled. */
-  if ((u54mc_plic_priority[irq] & 0x3) == 0)
+  if ((u54mc_plic_priority[irq] & U54_MC_PLIC_PRIO_MASK) == 0)
     interrupt_set_priority(irq, 1);
 }
 
 void interrupt_disable_external(uint32_t irq) {
-  size_t bank = 0;
-  while (irq >= 32) {
-    ++bank;
-    irq -= 32;
-  }
-  u54mc_plic_enable[bank] &= ~((uint32_t)1 << irq);
+  u54mc_plic_enable[U54_MC_PLIC_BANK(irq)] &= ~U54_MC_PLIC_BIT(irq);
 }
 
-void _isr_internal(void) {
+#ifdef PLIC_SINGLE_CLAIM
+/* One claim per trap, any other pending IRQ traps again right after the
+ * mret. Kept to compare against the claim loop below with /irq-bench. */
+FAST_TEXT void _isr_internal(void) {
+  ++u54mc_irq_stats.is_traps;
   uint32_t irq = *u54mc_plic_claim;
+  if (!irq)
+    return;
+  TRACE_EVENT(TRACE_ISR_ENTER, TRACE_CHAN_NONE, irq);
   isr(irq);
   *u54mc_plic_claim = irq;
+  ++u54mc_irq_stats.is_irqs;
+  TRACE_EVENT(TRACE_ISR_EXIT, TRACE_CHAN_NONE, irq);
+}
+#else
+/* Each claim returns the highest priority pending IRQ, or 0 once there are
+ * none left, so all IRQs pending at this point (and any raised while they're
+ * serviced) are handled in a single trap. */
+FAST_TEXT void _isr_internal(void) {
+  uint32_t irq;
+  ++u54mc_irq_stats.is_traps;
+  while ((irq = *u54mc_plic_claim)) {
+    TRACE_EVENT(TRACE_ISR_ENTER, TRACE_CHAN_NONE, irq);
+    isr(irq);
+    *u54mc_plic_claim = irq;
+    ++u54mc_irq_stats.is_irqs;
+    TRACE_EVENT(TRACE_ISR_EXIT, TRACE_CHAN_NONE, irq);
+  }
+}
+#endif
+
+void interrupt_get_stats(interrupt_stats_t *stats) {
+  stats->is_traps = u54mc_irq_stats.is_traps;
+  stats->is_irqs = u54mc_irq_stats.is_irqs;
 }
 
+/* Levels 1-7, level 0 disables the source */
 uint32_t interrupt_priority_count(void) {
-  return 7;
+  return U54_MC_PLIC_PRIO_MASK;
 }
 
 void interrupt_set_priority(uint32_t irq, uint32_t prio) {
-  const uint32_t mask = 0x3;
+  const uint32_t mask = U54_MC_PLIC_PRIO_MASK;
+
+  if (prio >= interrupt_priority_count())
+    prio = interrupt_priority_count() - 1;
 
   uint32_t reg = u54mc_plic_priority[irq];
-  reg = (reg & ~mask) | ((prio + 1) & mask);
+  reg = (reg & ~mask) | (prio + 1);
   u54mc_plic_priority[irq] = reg;
 }
@@ -1 +1,2 @@
-CPUFLAGS = -D__u54mc__ -march=rv32imczicsr -mabi=ilp32
+MARCH ?= rv32imczicsr
+CPUFLAGS = -D__u54mc__ -march=$(MARCH) -mabi=ilp32
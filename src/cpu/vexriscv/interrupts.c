@@ -19,6 +19,9 @@
 #include <stddef.h>
 #include <stdio.h>
 
+#include "common/sections.h"
+#include "common/trace.h"
+#include "cpu/interrupts.h"
 #include "cpu/riscv_csr.h"
 #include "stdio.h"
 
@@ -49,13 +52,24 @@ void interrupt_disable_external(uint32_t irq) {
 
 void isr(uint32_t irq);
 
-void _isr_internal(void) {
+static volatile interrupt_stats_t vexriscv_irq_stats FAST_DATA;
+
+FAST_TEXT void _isr_internal(void) {
   uint32_t mask = rv32_csr_read(VEXRISCV_INTC_CSR_MPEND);
+  ++vexriscv_irq_stats.is_traps;
+  TRACE_EVENT(TRACE_ISR_ENTER, TRACE_CHAN_NONE, mask);
   for(uint32_t irq = 0; irq < 32; ++irq) {
     if (((uint32_t)1 << irq) & mask) {
       isr(irq);
+      ++vexriscv_irq_stats.is_irqs;
     }
   }
+  TRACE_EVENT(TRACE_ISR_EXIT, TRACE_CHAN_NONE, mask);
+}
+
+void interrupt_get_stats(interrupt_stats_t *stats) {
+  stats->is_traps = vexriscv_irq_stats.is_traps;
+  stats->is_irqs = vexriscv_irq_stats.is_irqs;
 }
 
 uint32_t interrupt_priority_count(void) {
@@ -18,6 +18,8 @@
 
 #include "liteuart.h"
 
+#include "common/mmio.h"
+
 #define UART_EV_TX 0x1
 #define UART_EV_RX 0x2
 #define UART_BASE 0xe0001800
@@ -27,35 +29,49 @@
 #define CSR_UART_EV_PENDING_ADDR (UART_BASE + 0x10)
 #define CSR_UART_EV_ENABLE_ADDR (UART_BASE + 0x14)
 
+#define UART_REG(addr) (*(volatile unsigned int*)(addr))
+
 void uart_putc(unsigned char c) {
   unsigned char r;
   /* pending */
-  r = *(volatile unsigned int*)CSR_UART_EV_PENDING_ADDR;
-  *(volatile unsigned int*)CSR_UART_EV_PENDING_ADDR = r;
+  r = MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_EV_PENDING_ADDR));
+  MMIO_WRITE(MMIO_DEV_UART, UART_REG(CSR_UART_EV_PENDING_ADDR), r);
 
   /* enable */
-  *(volatile unsigned int*)CSR_UART_EV_ENABLE_ADDR = UART_EV_TX;
+  MMIO_WRITE(MMIO_DEV_UART, UART_REG(CSR_UART_EV_ENABLE_ADDR), UART_EV_TX);
 
   /* wait for space */
   do {
-    r = *(volatile unsigned int*)CSR_UART_TXFULL_ADDR;
+    r = MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_TXFULL_ADDR));
   } while (r);
   /* write */
-  *(volatile unsigned int*)CSR_UART_RXTX_ADDR = c;
+  MMIO_WRITE(MMIO_DEV_UART, UART_REG(CSR_UART_RXTX_ADDR), c);
 }
 
 unsigned char uart_getc(void) {
   unsigned char r;
   /* pending */
-  r = *(volatile unsigned int*)CSR_UART_EV_PENDING_ADDR;
-  *(volatile unsigned int*)CSR_UART_EV_PENDING_ADDR = r;
+  r = MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_EV_PENDING_ADDR));
+  MMIO_WRITE(MMIO_DEV_UART, UART_REG(CSR_UART_EV_PENDING_ADDR), r);
 
   /* enable */
-  *(volatile unsigned int*)CSR_UART_EV_ENABLE_ADDR = UART_EV_RX;
+  MMIO_WRITE(MMIO_DEV_UART, UART_REG(CSR_UART_EV_ENABLE_ADDR), UART_EV_RX);
 
   /* wait for input */
-  while (*(volatile unsigned int*)CSR_UART_RXEMPTY_ADDR)
+  while (MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_RXEMPTY_ADDR)))
     ;
-  r = *(volatile unsigned int*)CSR_UART_RXTX_ADDR;
+  r = MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_RXTX_ADDR));
   return r;
 }
+
+int uart_try_putc(unsigned char c) {
+  if (MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_TXFULL_ADDR))) return 0;
+  MMIO_WRITE(MMIO_DEV_UART, UART_REG(CSR_UART_RXTX_ADDR), c);
+  return 1;
+}
+
+int uart_try_getc(unsigned char* c) {
+  if (MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_RXEMPTY_ADDR))) return 0;
+  *c = MMIO_READ(MMIO_DEV_UART, UART_REG(CSR_UART_RXTX_ADDR));
+  return 1;
+}
@@ -18,25 +18,22 @@
 
 #include "rle.h"
 
+#include "common/sections.h"
+
 #ifdef RLE_DMA
 
-xls_dma_t* rle0_dma = (xls_dma_t*)RLE0_BASE;
+xls_dma_t* rle0_dma FAST_DATA = (xls_dma_t*)RLE0_BASE;
+
+XLS_DMA_MAN_DEFINE(rle0_dma_man, RLE_DMA_MAN_CHANS, FAST_DATA);
 
-#ifdef RLE_DMA_IRQ
-xls_dma_man_t rle0_dma_man = {
-    .dman_complete = 0,
-    .dman_tlast    = 0,
-    .dman_chan_data =
-        {[0] = {.dmanch_tsfr = NULL}, [1] = {.dmanch_tsfr = NULL}},
-};
-#endif /* RLE_DMA_IRQ */
+#endif /* RLE_DMA */
 
-#else /* RLE_DMA */
+#ifdef RLE_STREAM
 
-rle_io_t rle0_io = {
+rle_io_t rle0_io FAST_DATA = {
     .io_input_r =
-        (xls_stream_rle_enc_in_data_t*)(RLE0_BASE + RLE_INPUT_R_OFFSET),
+        (xls_stream_rle_enc_in_data_t*)(RLE_STREAM_BASE + RLE_INPUT_R_OFFSET),
     .io_output_s =
-        (xls_stream_rle_enc_out_data_t*)(RLE0_BASE + RLE_OUTPUT_S_OFFSET)};
+        (xls_stream_rle_enc_out_data_t*)(RLE_STREAM_BASE + RLE_OUTPUT_S_OFFSET)};
 
-#endif /* RLE_DMA */
+#endif /* RLE_STREAM */
@@ -26,6 +26,7 @@
 
 // clang-format off
 #define RLE0_BASE            0x70000000
+#define RLE1_BASE            0x70020000
 #define RLE_INPUT_R_OFFSET       0x0000
 #define RLE_OUTPUT_S_OFFSET      0x0400
 
@@ -41,13 +42,39 @@
 #define RLE_DMA_IRQ_NUM 4
 
 
-#define RLE_RD_CHAN                   0
-#define RLE_WR_CHAN                   1
+/* A hybrid build talks to two encoder instances: RLE0 with its channels bound
+ * to DMA and RLE1 with its channels exposed as streams. A single channel can't
+ * be managed by both at once. */
+#ifdef RLE_HYBRID
+#define RLE_STREAM_BASE      RLE1_BASE
+#else
+#define RLE_STREAM_BASE      RLE0_BASE
+#endif
 
 #define RLE_COUNT_WIDTH 2
 // clamng-format on
 
+/* Channels are allocated by direction from the DMA manager at startup. The
+ * manager has room for RLE_DMA_MAN_CHANS channels, the encoder needs two. */
+#ifndef RLE_DMA_MAN_CHANS
+#define RLE_DMA_MAN_CHANS 8
+#endif
+
+/* Width of a symbol in bits. Must match the SYMBOL_WIDTH parameter of the
+ * RunLengthEncoder proc the encoder IR was generated from. */
+#ifndef RLE_SYMBOL_WIDTH
+#define RLE_SYMBOL_WIDTH 32
+#endif
+
+#if RLE_SYMBOL_WIDTH == 8
+typedef uint8_t rle_sym_t;
+#elif RLE_SYMBOL_WIDTH == 16
+typedef uint16_t rle_sym_t;
+#elif RLE_SYMBOL_WIDTH == 32
 typedef uint32_t rle_sym_t;
+#else
+#error RLE_SYMBOL_WIDTH must be one of 8, 16, 32
+#endif
 
 typedef struct __attribute__((packed, aligned(1))) rle_enc_in_data {
   rle_sym_t e_sym;
@@ -76,10 +103,9 @@ typedef struct rle_io {
 
 #ifdef RLE_DMA
 extern xls_dma_t* rle0_dma;
-#ifdef RLE_DMA_IRQ
 extern xls_dma_man_t rle0_dma_man;
 #endif
-#else
+#ifdef RLE_STREAM
 extern rle_io_t rle0_io;
 #endif
 
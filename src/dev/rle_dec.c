@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "rle_dec.h"
+
+#include "common/sections.h"
+
+#ifdef RLE_DMA
+
+xls_dma_t* rle_dec0_dma FAST_DATA = (xls_dma_t*)RLE_DEC0_BASE;
+
+XLS_DMA_MAN_DEFINE(rle_dec0_dma_man, RLE_DMA_MAN_CHANS, FAST_DATA);
+
+#endif /* RLE_DMA */
+
+#ifdef RLE_STREAM
+
+rle_dec_io_t rle_dec0_io FAST_DATA = {
+    .io_input_r = (xls_stream_rle_enc_out_data_t*)(RLE_DEC0_BASE +
+                                                   RLE_DEC_INPUT_R_OFFSET),
+    .io_output_s = (xls_stream_rle_dec_out_data_t*)(RLE_DEC0_BASE +
+                                                    RLE_DEC_OUTPUT_S_OFFSET)};
+
+#endif /* RLE_STREAM */
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __RLE_DEC_H__
+#define __RLE_DEC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dev/rle.h"
+#include "xls/xls_dma.h"
+#include "xls/xls_stream.h"
+
+/* RLE decoder (XLS `rle_dec`). It takes the encoder's (symbol, count) records
+ * and outputs one symbol per transaction. Channels are bound the same way as
+ * for the encoder: streams at RLE_DEC_INPUT_R_OFFSET/RLE_DEC_OUTPUT_S_OFFSET,
+ * or DMA channels allocated from `rle_dec0_dma_man`. */
+
+// clang-format off
+#define RLE_DEC0_BASE              0x70040000
+#define RLE_DEC_INPUT_R_OFFSET         0x0000
+#define RLE_DEC_OUTPUT_S_OFFSET        0x0400
+
+#define RLE_DEC_DMA_IRQ_NUM 5
+// clang-format on
+
+/* Decoder input records have the layout of the encoder output */
+typedef rle_enc_out_data_t rle_dec_in_data_t;
+
+typedef struct __attribute__((packed, aligned(1))) rle_dec_out_data {
+  rle_sym_t d_sym;
+#ifndef RLE_DMA_AXI
+  uint8_t d_last : 1;
+#endif
+} rle_dec_out_data_t;
+
+XLS_TYPED_STREAM(rle_dec_out_data_t);
+
+typedef struct rle_dec_io {
+  xls_stream_rle_enc_out_data_t* const io_input_r;
+  xls_stream_rle_dec_out_data_t* const io_output_s;
+} rle_dec_io_t;
+
+#ifdef RLE_DMA
+extern xls_dma_t* rle_dec0_dma;
+extern xls_dma_man_t rle_dec0_dma_man;
+#endif
+#ifdef RLE_STREAM
+extern rle_dec_io_t rle_dec0_io;
+#endif
+
+#endif /* __RLE_DEC_H__ */
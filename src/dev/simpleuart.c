@@ -18,16 +18,32 @@
 
 #include "simpleuart.h"
 
+#include "common/mmio.h"
+
 #define UART_BASE 0xe0001800
 
+#define UART_REG (*(volatile unsigned int*)UART_BASE)
+
 void uart_putc(unsigned char c) {
-  *(volatile unsigned int*)UART_BASE = c;
+  MMIO_WRITE(MMIO_DEV_UART, UART_REG, c);
 }
 
 unsigned char uart_getc(void) {
   unsigned int c;
   do {
-    c = *(volatile unsigned int*)UART_BASE;
+    c = MMIO_READ(MMIO_DEV_UART, UART_REG);
   } while (c == 0); // SimpleUart returns zero on no data.
   return c;
 }
+
+int uart_try_putc(unsigned char c) {
+  uart_putc(c);
+  return 1;
+}
+
+int uart_try_getc(unsigned char* c) {
+  unsigned int r = MMIO_READ(MMIO_DEV_UART, UART_REG);
+  if (r == 0) return 0;
+  *c = r;
+  return 1;
+}
@@ -22,6 +22,10 @@
 void uart_putc(unsigned char c);
 unsigned char uart_getc(void);
 
+/* Non-blocking variants, return 1 on success and 0 if the UART isn't ready */
+int uart_try_putc(unsigned char c);
+int uart_try_getc(unsigned char* c);
+
 #define DEV_UART
 
 #endif  // DEV_SIMPLEUART_H_
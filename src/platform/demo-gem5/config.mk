@@ -1,2 +1,7 @@
 CPU = u54-mc
 DEVICES = rle simpleuart
+# Matches the --cpu-clock default of gem5_u54.py
+CPU_FREQ_HZ ?= 1000000000
+# Memory reserved for the input corpus (CORPUS=yes), below the stack
+CORPUS_ADDR ?= 0x48000000
+CORPUS_SIZE ?= 0x07000000
@@ -0,0 +1,151 @@
+# Copyright (C) 2024 Antmicro
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+
+# Sample gem5 configuration for the demo-gem5 firmware, approximating a single
+# SiFive U54 hart: in-order Minor CPU, 32 KiB L1 instruction and data caches,
+# on-chip SRAM and main RAM laid out as in linker.ld.
+#
+# Build the firmware with m5ops to get a separate stats.txt section for every
+# encode phase, and work item statistics (`system.work*`) for DMA transfers:
+#
+#   make PLATFORM=demo-gem5 M5OPS=yes
+#   gem5.opt src/platform/demo-gem5/gem5_u54.py \
+#       --firmware out/demo-gem5/fw_demo-gem5.elf
+#
+# With a firmware built with CORPUS=yes, `--corpus` loads a corpus made with
+# scripts/mkcorpus.py at CORPUS_ADDR, as a separate memory image:
+#
+#   gem5.opt src/platform/demo-gem5/gem5_u54.py \
+#       --firmware out/demo-gem5/fw_demo-gem5.elf --corpus corpus.bin
+#
+# The UART (0xe0001800) and the XLS peripherals are models from the
+# co-simulation fork of gem5 and have to be attached to `system.iobus` where
+# marked below, with the interrupt of each XLS peripheral routed to its PLIC
+# source from `xls_peripherals`. The decoder is only used by firmware built
+# with ROUNDTRIP=yes, which can compare one PLIC claim per trap against
+# claiming until none are pending with `/irq-bench`:
+#
+#   make PLATFORM=demo-gem5 DMA=dma INTERRUPTS=yes ROUNDTRIP=yes
+#   make PLATFORM=demo-gem5 DMA=dma INTERRUPTS=yes ROUNDTRIP=yes \
+#       IRQ_CLAIM=single OUT=out-single
+
+import argparse
+
+import m5
+from m5.objects import *
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--firmware', type=str, required=True,
+                    help='Firmware ELF file')
+parser.add_argument('--cpu-clock', type=str, default='1GHz')
+parser.add_argument('--l1-size', type=str, default='32KiB')
+parser.add_argument('--corpus', type=str, default=None,
+                    help='Input corpus, loaded at CORPUS_ADDR')
+args = parser.parse_args()
+
+
+class L1Cache(Cache):
+    assoc = 4
+    tag_latency = 1
+    data_latency = 1
+    response_latency = 1
+    mshrs = 4
+    tgts_per_mshr = 8
+
+
+system = System()
+system.clk_domain = SrcClockDomain(clock=args.cpu_clock,
+                                   voltage_domain=VoltageDomain())
+system.mem_mode = 'timing'
+# CORPUS_ADDR and CORPUS_SIZE from config.mk
+CORPUS_ADDR = 0x48000000
+CORPUS_SIZE = 0x07000000
+if args.corpus:
+    # Main RAM is split around the corpus image
+    system.mem_ranges = [AddrRange(0x40000000, CORPUS_ADDR),
+                         AddrRange(CORPUS_ADDR + CORPUS_SIZE, 0x50000000)]
+else:
+    system.mem_ranges = [AddrRange(0x40000000, size='256MiB')]
+
+system.cpu = RiscvMinorCPU()
+system.cpu.isa = [RiscvISA(riscv_type='RV32')]
+system.cpu.createThreads()
+system.cpu.createInterruptController()
+
+system.membus = SystemXBar()
+system.iobus = IOXBar()
+system.bridge = Bridge(delay='10ns')
+system.bridge.mem_side_port = system.iobus.cpu_side_ports
+system.bridge.cpu_side_port = system.membus.mem_side_ports
+system.bridge.ranges = [AddrRange(0x02000000, 0x10000000),
+                        AddrRange(0x70000000, 0x80000000),
+                        AddrRange(0xe0000000, 0xf0000000)]
+
+system.cpu.icache = L1Cache(size=args.l1_size, is_read_only=True,
+                            writeback_clean=True)
+system.cpu.dcache = L1Cache(size=args.l1_size)
+system.cpu.icache.cpu_side = system.cpu.icache_port
+system.cpu.dcache.cpu_side = system.cpu.dcache_port
+system.cpu.icache.mem_side = system.membus.cpu_side_ports
+system.cpu.dcache.mem_side = system.membus.cpu_side_ports
+system.cpu.mmu.connectWalkerPorts(system.membus.cpu_side_ports,
+                                  system.membus.cpu_side_ports)
+
+# On-chip SRAM used with FAST_MEM=yes
+system.sram = SimpleMemory(range=AddrRange(0x10000000, size='32KiB'),
+                           latency='1ns')
+system.sram.port = system.membus.mem_side_ports
+
+system.mem_ctrls = [MemCtrl(dram=DDR3_1600_8x8(range=r))
+                    for r in system.mem_ranges]
+for mem_ctrl in system.mem_ctrls:
+    mem_ctrl.port = system.membus.mem_side_ports
+
+if args.corpus:
+    # A raw image is loaded at the start of the memory range
+    system.corpus_mem = SimpleMemory(
+        range=AddrRange(CORPUS_ADDR, size=CORPUS_SIZE), latency='30ns',
+        image_file=args.corpus)
+    system.corpus_mem.port = system.membus.mem_side_ports
+
+system.rtc = RiscvRTC(frequency=Frequency('100MHz'))
+system.clint = Clint(pio_addr=0x02000000)
+system.clint.int_pin = system.rtc.int_pin
+system.clint.pio = system.iobus.mem_side_ports
+system.plic = Plic(pio_addr=0x0c000000, n_src=64, n_contexts=2)
+system.plic.pio = system.iobus.mem_side_ports
+
+# Base address, PLIC source and peripheral config of every XLS peripheral,
+# matching RLE0_BASE/RLE_DMA_IRQ_NUM and RLE_DEC0_BASE/RLE_DEC_DMA_IRQ_NUM
+xls_peripherals = [
+    (0x70000000, 4, 'rle_enc_sm_dma.textproto'),
+    (0x70040000, 5, 'rle_dec_sm_dma.textproto'),
+]
+
+# Attach the UART and XLS peripheral models of the co-simulation fork here,
+# e.g. system.uart.pio = system.iobus.mem_side_ports
+
+system.system_port = system.membus.cpu_side_ports
+
+system.workload = RiscvBareMetal(bootloader=args.firmware)
+
+root = Root(full_system=True, system=system)
+m5.instantiate()
+
+print('Running the firmware...')
+event = m5.simulate()
+print(f'Exiting @ tick {m5.curTick()}: {event.getCause()}')
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PLATFORM_DEMO_GEM5_M5OPS_H_
+#define PLATFORM_DEMO_GEM5_M5OPS_H_
+
+#include <stdint.h>
+
+/* gem5 pseudo-instructions ("m5ops") using the magic instruction interface.
+ *
+ * On RISC-V an m5op is encoded in the custom-3 opcode space as
+ * `0x7b | (func << 25)`, with arguments passed in a0, a1 and the result
+ * returned in a0. gem5 executes them as simulator commands; on real hardware
+ * or in any other simulator they raise an illegal instruction exception, so
+ * this header must only be used in gem5 builds. */
+
+#define M5OP_RESET_STATS 0x40
+#define M5OP_DUMP_STATS  0x41
+#define M5OP_WORK_BEGIN  0x5a
+#define M5OP_WORK_END    0x5b
+
+#define M5OP_STR_(x) #x
+#define M5OP_STR(x)  M5OP_STR_(x)
+
+#define M5OP(func, arg0, arg1)                                         \
+  do {                                                                 \
+    register uint32_t m5_a0 asm("a0") = (arg0);                        \
+    register uint32_t m5_a1 asm("a1") = (arg1);                        \
+    asm volatile(".insn r 0x7b, 0, " M5OP_STR(func) ", x0, x0, x0"     \
+                 : "+r"(m5_a0)                                         \
+                 : "r"(m5_a1)                                          \
+                 : "memory");                                          \
+  } while (0)
+
+/* Resets all statistics after `delay_ns`, and every `period_ns` afterwards
+ * if it's non-zero. */
+static inline void m5_reset_stats(uint32_t delay_ns, uint32_t period_ns) {
+  M5OP(M5OP_RESET_STATS, delay_ns, period_ns);
+}
+
+/* Appends the current statistics to stats.txt, with the same timing
+ * arguments as `m5_reset_stats`. */
+static inline void m5_dump_stats(uint32_t delay_ns, uint32_t period_ns) {
+  M5OP(M5OP_DUMP_STATS, delay_ns, period_ns);
+}
+
+/* Marks the beginning and end of a work item. gem5 accounts the number and
+ * duration of work items per `work_id` in the `system.work*` statistics. */
+static inline void m5_work_begin(uint32_t work_id, uint32_t thread_id) {
+  M5OP(M5OP_WORK_BEGIN, work_id, thread_id);
+}
+
+static inline void m5_work_end(uint32_t work_id, uint32_t thread_id) {
+  M5OP(M5OP_WORK_END, work_id, thread_id);
+}
+
+#endif /* PLATFORM_DEMO_GEM5_M5OPS_H_ */
@@ -1,2 +1,7 @@
 CPU = vexriscv
 DEVICES = rle liteuart
+# Renode executes 100 MIPS by default, used to turn cycles into rates
+CPU_FREQ_HZ ?= 100000000
+# Memory reserved for the input corpus (CORPUS=yes), below the stack
+CORPUS_ADDR ?= 0x48000000
+CORPUS_SIZE ?= 0x07000000
@@ -3,6 +3,12 @@ $(OUTROOT)/xls:
 OUTDIRS += $(OUTROOT)/xls
 
 XLS_SRCS = \
-	xls_dma.c
+	xls_chan.c \
+	xls_dma.c \
+	xls_dma_async.c \
+	xls_dma_session.c \
+	xls_dma_man.c \
+	xls_dma_ring.c \
+	xls_dma_pool.c
 
 OBJS += $(patsubst %.c,$(OUTROOT)/xls/%.o,$(XLS_SRCS))
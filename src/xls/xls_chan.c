@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "xls_chan.h"
+
+#include <string.h>
+
+#include "common/mmio.h"
+#include "common/sections.h"
+#include "cpu/riscv_csr.h"
+
+/* Stream backend */
+
+static inline volatile uint8_t* stream_data(const xls_chan_t* ch) {
+  return (volatile uint8_t*)ch->ch_stream + sizeof(xls_stream_t);
+}
+
+/* Records are packed, so they're copied through 32-bit words and the tail
+ * byte by byte, the same accesses a typed stream compiles to */
+static void stream_write_rec(volatile uint8_t* reg, const uint8_t* rec,
+                             size_t size) {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    uint32_t word;
+    memcpy(&word, rec + i, 4);
+    MMIO_WRITE(MMIO_DEV_XLS, *(volatile uint32_t*)(reg + i), word);
+  }
+  for (; i < size; ++i) {
+    MMIO_WRITE(MMIO_DEV_XLS, reg[i], rec[i]);
+  }
+}
+
+static void stream_read_rec(volatile uint8_t* reg, uint8_t* rec,
+                            size_t size) {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    uint32_t word = MMIO_READ(MMIO_DEV_XLS, *(volatile uint32_t*)(reg + i));
+    memcpy(rec + i, &word, 4);
+  }
+  for (; i < size; ++i) {
+    rec[i] = MMIO_READ(MMIO_DEV_XLS, reg[i]);
+  }
+}
+
+static int stream_submit(xls_chan_t* ch) {
+  ch->ch_len -= ch->ch_len % ch->ch_rec_size;
+  return XLS_DMA_OK;
+}
+
+FAST_TEXT static int stream_test(xls_chan_t* ch) {
+  volatile uint8_t* reg = stream_data(ch);
+
+  while (ch->ch_done < ch->ch_len && xls_is_ready(ch->ch_stream)) {
+    uint8_t* rec = ch->ch_data + ch->ch_done;
+    if (ch->ch_dir == XLS_TSFR_TO_PERIPHERAL) {
+      stream_write_rec(reg, rec, ch->ch_rec_size);
+      MMIO_SET(MMIO_DEV_XLS, ch->ch_stream->s_ctrl, XLS_SCTRL_DOXFER);
+      ch->ch_done += ch->ch_rec_size;
+      continue;
+    }
+
+    MMIO_SET(MMIO_DEV_XLS, ch->ch_stream->s_ctrl, XLS_SCTRL_DOXFER);
+    stream_read_rec(reg, rec, ch->ch_rec_size);
+    ch->ch_done += ch->ch_rec_size;
+    if (ch->ch_is_last && ch->ch_is_last(rec)) {
+      return XLS_DMA_OK;
+    }
+  }
+
+  return ch->ch_done < ch->ch_len ? XLS_DMA_PENDING : XLS_DMA_OK;
+}
+
+/* Records already moved stay counted in `ch_done` */
+static void stream_cancel(xls_chan_t* ch) {}
+
+static void stream_close(xls_chan_t* ch) {}
+
+static const xls_chan_ops_t stream_ops = {
+    .ops_submit = stream_submit,
+    .ops_test   = stream_test,
+    .ops_cancel = stream_cancel,
+    .ops_close  = stream_close,
+};
+
+/* DMA backends */
+
+FAST_TEXT static int dma_submit(xls_chan_t* ch) {
+  ch->ch_tsfr.tsfr_data = ch->ch_data;
+  ch->ch_tsfr.tsfr_len  = ch->ch_len;
+  xls_dma_poll_ready(&ch->ch_tsfr);
+  return xls_dma_session_submit(&ch->ch_sess, &ch->ch_tsfr, &ch->ch_handle);
+}
+
+/* Looks for the record ending the packet among the ones written so far by
+ * the transfer in flight. `ch_done` tracks the records already checked. */
+FAST_TEXT static int dma_find_last(xls_chan_t* ch) {
+  const xls_dma_chan_t* chan =
+      &ch->ch_sess.sess_dma->dma_chans[ch->ch_sess.sess_chan];
+  size_t written = MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
+
+  while (ch->ch_done + ch->ch_rec_size <= written) {
+    const uint8_t* rec = ch->ch_data + ch->ch_done;
+    ch->ch_done += ch->ch_rec_size;
+    if (ch->ch_is_last(rec)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+FAST_TEXT static int dma_test(xls_chan_t* ch) {
+  int status = xls_dma_test(ch->ch_handle);
+  if (status != XLS_DMA_PENDING) {
+    ch->ch_done = ch->ch_tsfr.tsfr_transferred_bytes;
+    return status;
+  }
+
+  if (ch->ch_is_last && ch->ch_dir == XLS_TSFR_FROM_PERIPHERAL &&
+      dma_find_last(ch)) {
+    /* The rest of the buffer would only be filled by the next packet */
+    size_t done = ch->ch_done;
+    xls_dma_cancel(ch->ch_handle);
+    ch->ch_done = done;
+    return XLS_DMA_OK;
+  }
+  return status;
+}
+
+static void dma_cancel(xls_chan_t* ch) {
+  xls_dma_cancel(ch->ch_handle);
+  ch->ch_done = ch->ch_tsfr.tsfr_transferred_bytes;
+}
+
+static void dma_close(xls_chan_t* ch) { xls_dma_session_close(&ch->ch_sess); }
+
+/* DMA and AXI-like DMA, polled or interrupt-driven, only differ in how the
+ * session is set up */
+static const xls_chan_ops_t dma_ops = {
+    .ops_submit = dma_submit,
+    .ops_test   = dma_test,
+    .ops_cancel = dma_cancel,
+    .ops_close  = dma_close,
+};
+
+/* Indexed by [tlast][interrupts] */
+static const char* const dma_names[2][2] = {
+    {"dma", "dma-irq"},
+    {"axidma", "axidma-irq"},
+};
+
+/* Common */
+
+int xls_chan_open_stream(xls_chan_t* ch, xls_stream_t* stream,
+                         size_t rec_size, xls_tsf_dir_t dir) {
+  if (!rec_size) return XLS_DMA_BADARG;
+
+  memset(ch, 0, sizeof(*ch));
+  ch->ch_ops      = &stream_ops;
+  ch->ch_name     = "stream";
+  ch->ch_dir      = dir;
+  ch->ch_status   = XLS_DMA_OK;
+  ch->ch_stream   = stream;
+  ch->ch_rec_size = rec_size;
+
+  return XLS_DMA_OK;
+}
+
+int xls_chan_open_dma(xls_chan_t* ch, xls_dma_t* dma, uint64_t chan,
+                      xls_tsf_dir_t dir, xls_dma_man_t* dma_man, int tlast) {
+  memset(ch, 0, sizeof(*ch));
+
+  int err;
+  if ((err = xls_dma_session_open(&ch->ch_sess, dma, chan, dir, dma_man))) {
+    return err;
+  }
+
+  ch->ch_ops            = &dma_ops;
+  ch->ch_name           = dma_names[!!tlast][dma_man != NULL];
+  ch->ch_dir            = dir;
+  ch->ch_tlast          = !!tlast;
+  ch->ch_status         = XLS_DMA_OK;
+  ch->ch_tsfr.tsfr_dma  = dma;
+  ch->ch_tsfr.tsfr_chan = chan;
+
+  return XLS_DMA_OK;
+}
+
+void xls_chan_close(xls_chan_t* ch) {
+  xls_chan_cancel(ch);
+  ch->ch_ops->ops_close(ch);
+}
+
+void xls_chan_on_complete(xls_chan_t* ch, xls_dma_tsfr_callback_t callback,
+                          void* ctx) {
+  ch->ch_tsfr.tsfr_callback_isr = callback;
+  ch->ch_tsfr.tsfr_ctx          = ctx;
+}
+
+void xls_chan_end_on(xls_chan_t* ch, size_t rec_size,
+                     xls_chan_last_fn_t is_last) {
+  ch->ch_rec_size = rec_size;
+  ch->ch_is_last  = is_last;
+}
+
+void xls_chan_coalesce(xls_chan_t* ch, uint32_t every, int tlast) {
+  if (!xls_chan_is_stream(ch)) {
+    xls_dma_session_coalesce(&ch->ch_sess, every, tlast);
+  }
+}
+
+FAST_TEXT int xls_chan_complete(xls_chan_t* ch, uint64_t timeout) {
+  size_t done    = ch->ch_done;
+  uint64_t idle  = 0;
+  uint32_t since = rv32_csr_read(CSR_MCYCLE);
+  int status;
+
+  ch->ch_idle_cycles = 0;
+  while ((status = xls_chan_test(ch)) == XLS_DMA_PENDING) {
+    if (ch->ch_done != done) {
+      done  = ch->ch_done;
+      idle  = 0;
+      since = rv32_csr_read(CSR_MCYCLE);
+    } else if (timeout && ++idle >= timeout) {
+      ch->ch_idle_cycles = rv32_csr_read(CSR_MCYCLE) - since;
+      return XLS_DMA_TIMEOUT;
+    }
+  }
+
+  return status;
+}
+
+FAST_TEXT int xls_chan_complete_pair(xls_chan_t* tx, xls_chan_t* rx,
+                                     uint64_t timeout) {
+  int status;
+
+  while ((status = xls_chan_test(tx)) == XLS_DMA_PENDING) {
+    xls_chan_test(rx);
+  }
+  if (status != XLS_DMA_OK) {
+    return status;
+  }
+
+  return xls_chan_complete(rx, timeout);
+}
+
+int xls_chan_send(xls_chan_t* ch, const void* data, size_t len) {
+  int err;
+  if ((err = xls_chan_submit(ch, (void*)data, len))) {
+    return err;
+  }
+  return xls_chan_complete(ch, 0);
+}
+
+int xls_chan_recv(xls_chan_t* ch, void* data, size_t len, uint64_t timeout,
+                  size_t* received) {
+  int err;
+  if ((err = xls_chan_submit(ch, data, len))) {
+    *received = 0;
+    return err;
+  }
+  if ((err = xls_chan_complete(ch, timeout)) == XLS_DMA_TIMEOUT) {
+    xls_chan_cancel(ch);
+  }
+  *received = xls_chan_transferred(ch);
+  return err;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __XLS_CHAN_H__
+#define __XLS_CHAN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xls_dma.h"
+#include "xls_dma_async.h"
+#include "xls_dma_session.h"
+#include "xls_stream.h"
+
+/* Transport-agnostic channels.
+ *
+ * A channel moves a buffer of records to or from one channel of an XLS
+ * peripheral, regardless of how that channel is exposed. The backend is
+ * picked when the channel is opened:
+ *
+ *   stream      - polled stream registers, one record per transaction
+ *   dma         - DMA channel, polled completion
+ *   dma-irq     - DMA channel, completion signalled with an interrupt
+ *   axidma      - AXI DMA channel, the peripheral ends packets with TLAST
+ *   axidma-irq  - as above, with interrupts
+ *
+ * Streams have no interrupt line, so there's no interrupt-driven stream
+ * backend. DMA backends go through a persistent session (xls_dma_session.h),
+ * so the channel must not be driven by any other session at the same time.
+ *
+ * `xls_chan_submit` starts a transfer and `xls_chan_test` makes progress
+ * without blocking, returning XLS_DMA_PENDING until the transfer finishes.
+ * Stream transfers are moved by `xls_chan_test` itself, one record at a time
+ * while the stream is ready, so a producer and a consumer channel of the same
+ * peripheral have to be tested in turns (see `xls_chan_complete_pair`).
+ *
+ * Dispatch is a single indirect call per operation. All functions return
+ * XLS_DMA_* codes. */
+
+struct xls_chan;
+
+/* Returns non-zero for a received record that ends the packet */
+typedef int (*xls_chan_last_fn_t)(const void* rec);
+
+typedef struct xls_chan_ops {
+  int (*ops_submit)(struct xls_chan* ch); /* Transfer set up in `ch` */
+  int (*ops_test)(struct xls_chan* ch);
+  void (*ops_cancel)(struct xls_chan* ch);
+  void (*ops_close)(struct xls_chan* ch);
+} xls_chan_ops_t;
+
+typedef struct xls_chan {
+  const xls_chan_ops_t* ch_ops;
+  const char* ch_name;    /* Backend, e.g. "stream" or "axidma-irq" */
+  xls_tsf_dir_t ch_dir;
+  uint8_t ch_tlast;       /* Peripheral ends incoming packets on its own */
+  uint8_t* ch_data;       /* Buffer of the current transfer */
+  size_t ch_len;          /* Length of the current transfer in bytes */
+  size_t ch_done;         /* Bytes transferred so far */
+  int ch_status;          /* Status of the last finished transfer */
+  uint32_t ch_idle_cycles; /* Cycles without progress before the last
+                            * xls_chan_complete timed out */
+  size_t ch_rec_size;     /* Record size, moved per stream transaction */
+  xls_chan_last_fn_t ch_is_last; /* Ends incoming packets, see
+                                  * xls_chan_end_on */
+  /* stream */
+  xls_stream_t* ch_stream;
+  /* dma, axidma */
+  xls_dma_session_t ch_sess;
+  xls_dma_tsfr_t ch_tsfr;
+  xls_dma_handle_t ch_handle;
+} xls_chan_t;
+
+/* `stream` points to a typed stream (see XLS_TYPED_STREAM) carrying records
+ * of `rec_size` bytes. Returns XLS_DMA_BADARG if `rec_size` is 0. */
+int xls_chan_open_stream(xls_chan_t* ch, xls_stream_t* stream,
+                         size_t rec_size, xls_tsf_dir_t dir);
+
+/* Transfers use interrupts if `dma_man` is non-NULL and polling otherwise.
+ * `tlast` selects the AXI DMA backends. */
+int xls_chan_open_dma(xls_chan_t* ch, xls_dma_t* dma, uint64_t chan,
+                      xls_tsf_dir_t dir, xls_dma_man_t* dma_man, int tlast);
+
+/* Stops the channel. Pending transfers are cancelled. */
+void xls_chan_close(xls_chan_t* ch);
+
+/* Sets the completion callback of DMA transfers, ignored by streams */
+void xls_chan_on_complete(xls_chan_t* ch, xls_dma_tsfr_callback_t callback,
+                          void* ctx);
+
+/* Sets the interrupt coalescing policy of interrupt-driven DMA transfers (see
+ * xls_dma_session_coalesce), ignored by other backends */
+void xls_chan_coalesce(xls_chan_t* ch, uint32_t every, int tlast);
+
+/* Incoming transfers finish as soon as a record for which `is_last` returns
+ * non-zero has been received, instead of waiting for the rest of the buffer
+ * to fill up. Records are `rec_size` bytes long, which for streams must be
+ * the record size the channel was opened with. NULL restores the default.
+ *
+ * DMA backends find the record by following `dmach_tsfr_donelen` while the
+ * transfer is in flight and cancel the rest of it. If the DMA only updates
+ * the register at completion, the transfer finishes as before, on its length
+ * or on the caller's timeout. */
+void xls_chan_end_on(xls_chan_t* ch, size_t rec_size,
+                     xls_chan_last_fn_t is_last);
+
+/* Marks the following transfers as the last segments of a request, which
+ * always raise an interrupt under a coalescing policy */
+static inline void xls_chan_set_final(xls_chan_t* ch, int final) {
+  ch->ch_tsfr.tsfr_final = !!final;
+}
+
+static inline const char* xls_chan_name(const xls_chan_t* ch) {
+  return ch->ch_name;
+}
+
+static inline int xls_chan_is_stream(const xls_chan_t* ch) {
+  return ch->ch_stream != NULL;
+}
+
+/* `data` must stay valid until the transfer finishes */
+static inline int xls_chan_submit(xls_chan_t* ch, void* data, size_t len) {
+  ch->ch_data   = data;
+  ch->ch_len    = len;
+  ch->ch_done   = 0;
+  ch->ch_status = XLS_DMA_PENDING;
+  int err       = ch->ch_ops->ops_submit(ch);
+  if (err) ch->ch_status = err;
+  return err;
+}
+
+static inline int xls_chan_test(xls_chan_t* ch) {
+  if (ch->ch_status == XLS_DMA_PENDING) {
+    ch->ch_status = ch->ch_ops->ops_test(ch);
+  }
+  return ch->ch_status;
+}
+
+/* Has no effect on a finished transfer. Otherwise the transfer finishes with
+ * XLS_DMA_CANCELLED and `ch_done` holds the number of bytes moved so far. */
+static inline void xls_chan_cancel(xls_chan_t* ch) {
+  if (ch->ch_status == XLS_DMA_PENDING) {
+    ch->ch_ops->ops_cancel(ch);
+    ch->ch_status = XLS_DMA_CANCELLED;
+  }
+}
+
+static inline size_t xls_chan_transferred(const xls_chan_t* ch) {
+  return ch->ch_done;
+}
+
+/* Waits for the transfer to finish. `timeout` is a number of polling
+ * iterations without progress, 0 waits indefinitely. Returns the status of
+ * the transfer or XLS_DMA_TIMEOUT, in which case it's still pending and
+ * `ch_idle_cycles` holds the cycles spent waiting since the last progress. */
+int xls_chan_complete(xls_chan_t* ch, uint64_t timeout);
+
+/* Waits for a transfer to the peripheral to finish, while draining the
+ * transfer from it, then waits for the latter with `timeout` */
+int xls_chan_complete_pair(xls_chan_t* tx, xls_chan_t* rx, uint64_t timeout);
+
+/* Blocking counterparts of submit + complete */
+int xls_chan_send(xls_chan_t* ch, const void* data, size_t len);
+
+/* Receives up to `len` bytes. Unless the channel ends packets on its own
+ * (`ch_tlast`), the end of a shorter packet can only be detected with
+ * a timeout: the transfer is then cancelled and XLS_DMA_TIMEOUT is returned.
+ * `received` is set in both cases. */
+int xls_chan_recv(xls_chan_t* ch, void* data, size_t len, uint64_t timeout,
+                  size_t* received);
+
+#endif /* __XLS_CHAN_H__ */
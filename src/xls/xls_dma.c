@@ -20,7 +20,12 @@
 
 #include <stdint.h>
 
+#include "common/mmio.h"
+#include "common/perf_region.h"
+#include "common/sections.h"
+#include "cpu/riscv_csr.h"
 #include "stdio.h"
+#include "xls_dma_man.h"
 
 static inline xls_dma_chan_t* get_tsfr_chan(xls_dma_tsfr_t* tsfr) {
   return &tsfr->tsfr_dma->dma_chans[tsfr->tsfr_chan];
@@ -43,6 +48,20 @@ const char* xls_dma_err_name(int code) {
       return "TIMEOUT";
     case XLS_DMA_NOMAN:
       return "NOMAN";
+    case XLS_DMA_NOMEM:
+      return "NOMEM";
+    case XLS_DMA_BADPTR:
+      return "BADPTR";
+    case XLS_DMA_DOUBLEFREE:
+      return "DOUBLEFREE";
+    case XLS_DMA_PENDING:
+      return "PENDING";
+    case XLS_DMA_CANCELLED:
+      return "CANCELLED";
+    case XLS_DMA_NOCHAN:
+      return "NOCHAN";
+    case XLS_DMA_BADARG:
+      return "BADARG";
     case XLS_DMA_OK:
       return "OK";
     default:
@@ -50,78 +69,93 @@ const char* xls_dma_err_name(int code) {
   }
 }
 
-void xls_dma_poll_ready(const xls_dma_tsfr_t* tsfr) {
+FAST_TEXT void xls_dma_poll_ready(const xls_dma_tsfr_t* tsfr) {
   const xls_dma_chan_t* dma_chan = get_tsfr_chan_const(tsfr);
-  while (!(dma_chan->dmach_ctrl & XLS_DMACH_CTRL_RDY))
+  while (!(MMIO_READ(MMIO_DEV_XLS, dma_chan->dmach_ctrl) & XLS_DMACH_CTRL_RDY))
     ;
 }
 
-int xls_dma_begin_transfer(xls_dma_tsfr_t* tsfr) {
+FAST_TEXT int xls_dma_begin_transfer(xls_dma_tsfr_t* tsfr) {
   xls_dma_chan_t* dma_chan = get_tsfr_chan(tsfr);
 
-  dma_chan->dmach_ctrl = 0;
+  MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_ctrl, 0);
 
-  int valid_dir = dma_chan->dmach_ctrl & XLS_DMACH_CTRL_DIR
-                      ? (tsfr->tsfr_dir == XLS_TSFR_FROM_PERIPHERAL)
-                      : (tsfr->tsfr_dir == XLS_TSFR_TO_PERIPHERAL);
+  int valid_dir =
+      MMIO_READ(MMIO_DEV_XLS, dma_chan->dmach_ctrl) & XLS_DMACH_CTRL_DIR
+          ? (tsfr->tsfr_dir == XLS_TSFR_FROM_PERIPHERAL)
+          : (tsfr->tsfr_dir == XLS_TSFR_TO_PERIPHERAL);
   if (!valid_dir) return XLS_DMA_START_WRONGDIR;
 
-  if (!(dma_chan->dmach_ctrl & XLS_DMACH_CTRL_RDY)) {
+  if (!(MMIO_READ(MMIO_DEV_XLS, dma_chan->dmach_ctrl) & XLS_DMACH_CTRL_RDY)) {
     return XLS_DMA_START_NOT_RDY;
   }
 
   if (tsfr->tsfr_polling) {
-    dma_chan->dmach_irqs |= -1;
-    tsfr->tsfr_dma->dma_irq_mask &= ~(1 << tsfr->tsfr_chan);
+    MMIO_SET(MMIO_DEV_XLS, dma_chan->dmach_irqs, -1);
+    MMIO_CLEAR(MMIO_DEV_XLS, tsfr->tsfr_dma->dma_irq_mask,
+               XLS_DMA_CHAN_BIT(tsfr->tsfr_chan));
   } else {
     if (!tsfr->tsfr_dma_man) {
       return XLS_DMA_NOMAN;
     }
-    tsfr->tsfr_dma_man->dman_chan_data[tsfr->tsfr_chan].dmanch_tsfr = tsfr;
-    tsfr->tsfr_dma_man->dman_complete &= ~(1 << tsfr->tsfr_chan);
-    tsfr->tsfr_dma_man->dman_tlast &= ~(1 << tsfr->tsfr_chan);
-    tsfr->tsfr_dma->dma_irq_mask |= 1 << tsfr->tsfr_chan;
-    dma_chan->dmach_ctrl |= XLS_DMACH_CTRL_IRQMASK_TSFRDONE;
+    xls_dma_man_track(tsfr->tsfr_dma_man, tsfr);
+    MMIO_SET(MMIO_DEV_XLS, tsfr->tsfr_dma->dma_irq_mask,
+             XLS_DMA_CHAN_BIT(tsfr->tsfr_chan));
+    MMIO_SET(MMIO_DEV_XLS, dma_chan->dmach_ctrl,
+             XLS_DMACH_CTRL_IRQMASK_TSFRDONE);
   }
 
   if (tsfr->tsfr_ignore) {
-    dma_chan->dmach_ctrl &= ~XLS_DMACH_CTRL_MODE;
+    MMIO_CLEAR(MMIO_DEV_XLS, dma_chan->dmach_ctrl, XLS_DMACH_CTRL_MODE);
   } else {
-    dma_chan->dmach_ctrl |= XLS_DMACH_CTRL_MODE;
-    dma_chan->dmach_tsfr_base = (size_t)tsfr->tsfr_data;
+    MMIO_SET(MMIO_DEV_XLS, dma_chan->dmach_ctrl, XLS_DMACH_CTRL_MODE);
+    MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_tsfr_base,
+               (size_t)tsfr->tsfr_data);
   }
-  dma_chan->dmach_tsfr_len = tsfr->tsfr_len;
+  MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_tsfr_len, tsfr->tsfr_len);
 
-  tsfr->tsfr_done = 0;
-  dma_chan->dmach_ctrl |= XLS_DMACH_CTRL_TSFR;
+  tsfr->tsfr_done  = 0;
+  tsfr->tsfr_quiet = 0;
+  TRACE_EVENT(TRACE_TSFR_BEGIN, tsfr->tsfr_chan, tsfr->tsfr_len);
+  PERF_WORK_BEGIN(PERF_WORK_DMA(tsfr->tsfr_chan));
+  MMIO_SET(MMIO_DEV_XLS, dma_chan->dmach_ctrl, XLS_DMACH_CTRL_TSFR);
 
   return XLS_DMA_OK;
 }
 
-int xls_dma_complete_transfer(xls_dma_tsfr_t* tsfr, uint64_t timeout) {
+FAST_TEXT int xls_dma_complete_transfer(xls_dma_tsfr_t* tsfr,
+                                        uint64_t timeout) {
   xls_dma_chan_t* chan = get_tsfr_chan(tsfr);
 
   int done;
 
   if (tsfr->tsfr_polling) {
     if (timeout == 0) {
-      while (!(chan->dmach_ctrl & XLS_DMACH_CTRL_TSFRDONE))
+      while (!(MMIO_READ(MMIO_DEV_XLS, chan->dmach_ctrl) &
+               XLS_DMACH_CTRL_TSFRDONE))
         ;
-      tsfr->tsfr_done              = 1;
-      tsfr->tsfr_transferred_bytes = chan->dmach_tsfr_donelen;
-      if (tsfr->tsfr_callback_isr) {
-        tsfr->tsfr_callback_isr(tsfr);
-      }
+      tsfr->tsfr_done = 1;
+      tsfr->tsfr_transferred_bytes =
+          MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
+      TRACE_EVENT(TRACE_TSFR_COMPLETE, tsfr->tsfr_chan,
+                  tsfr->tsfr_transferred_bytes);
+      PERF_WORK_END(PERF_WORK_DMA(tsfr->tsfr_chan));
+      xls_dma_notify(tsfr);
       return XLS_DMA_OK;
     }
 
-    while (timeout-- && !(done = chan->dmach_ctrl & XLS_DMACH_CTRL_TSFRDONE))
+    while (timeout-- && !(done = MMIO_READ(MMIO_DEV_XLS, chan->dmach_ctrl) &
+                                 XLS_DMACH_CTRL_TSFRDONE))
       ;
-    tsfr->tsfr_transferred_bytes = chan->dmach_tsfr_donelen;
+    tsfr->tsfr_transferred_bytes =
+        MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
     tsfr->tsfr_done              = done ? 1 : 0;
-    if (tsfr->tsfr_callback_isr) {
-      tsfr->tsfr_callback_isr(tsfr);
+    if (done) {
+      TRACE_EVENT(TRACE_TSFR_COMPLETE, tsfr->tsfr_chan,
+                  tsfr->tsfr_transferred_bytes);
+      PERF_WORK_END(PERF_WORK_DMA(tsfr->tsfr_chan));
     }
+    xls_dma_notify(tsfr);
     return done ? XLS_DMA_OK : XLS_DMA_TIMEOUT;
   }
 
@@ -129,11 +163,13 @@ int xls_dma_complete_transfer(xls_dma_tsfr_t* tsfr, uint64_t timeout) {
     return XLS_DMA_NOMAN;
   }
   if (timeout == 0) {
-    while (!(tsfr->tsfr_done))
+    while (!(tsfr->tsfr_quiet ? xls_dma_reap_transfer(tsfr) : tsfr->tsfr_done))
       ;
     return XLS_DMA_OK;
   }
-  while (timeout-- && !(done = tsfr->tsfr_done))
+  while (timeout-- &&
+         !(done = tsfr->tsfr_quiet ? xls_dma_reap_transfer(tsfr)
+                                   : tsfr->tsfr_done))
     ;
   if (!done) {
     return XLS_DMA_TIMEOUT;
@@ -143,35 +179,82 @@ int xls_dma_complete_transfer(xls_dma_tsfr_t* tsfr, uint64_t timeout) {
 
 void xls_dma_cancel_transfer(xls_dma_tsfr_t* tsfr) {
   xls_dma_chan_t* chan = get_tsfr_chan(tsfr);
-  chan->dmach_ctrl     = 0;
+  TRACE_EVENT(TRACE_TSFR_CANCEL, tsfr->tsfr_chan, 0);
+  PERF_WORK_END(PERF_WORK_DMA(tsfr->tsfr_chan));
+  MMIO_WRITE(MMIO_DEV_XLS, chan->dmach_ctrl, 0);
 }
 
-void xls_dma_update_isr(xls_dma_t* dma, xls_dma_man_t* dma_man) {
+FAST_TEXT int xls_dma_reap_transfer(xls_dma_tsfr_t* tsfr) {
+  if (tsfr->tsfr_done) return 1;
+
+  xls_dma_chan_t* chan = get_tsfr_chan(tsfr);
+  if (!(MMIO_READ(MMIO_DEV_XLS, chan->dmach_ctrl) & XLS_DMACH_CTRL_TSFRDONE)) {
+    return 0;
+  }
+
+  /* The ISR may still complete the transfer on TLAST */
+  uint32_t irq_state = rv32_irq_save();
+  if (tsfr->tsfr_done) {
+    rv32_irq_restore(irq_state);
+    return 1;
+  }
+  xls_dma_man_t* dma_man = tsfr->tsfr_dma_man;
+  dma_man->dman_complete |= XLS_DMA_CHAN_BIT(tsfr->tsfr_chan);
+  /* Status bits are latched even if their interrupts are masked. Left set,
+   * they would fire as soon as the next transfer unmasks them. */
+  MMIO_WRITE(MMIO_DEV_XLS, chan->dmach_irqs, 0xff);
+  tsfr->tsfr_transferred_bytes =
+      MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
+  tsfr->tsfr_done = 1;
+
+  TRACE_EVENT(TRACE_TSFR_COMPLETE, tsfr->tsfr_chan,
+              tsfr->tsfr_transferred_bytes);
+  PERF_WORK_END(PERF_WORK_DMA(tsfr->tsfr_chan));
+  xls_dma_notify(tsfr);
+  xls_dma_man_idle(dma_man, tsfr->tsfr_chan);
+  rv32_irq_restore(irq_state);
+  return 1;
+}
+
+FAST_TEXT void xls_dma_update_isr(xls_dma_t* dma, xls_dma_man_t* dma_man) {
   /* Ideally this should be a reentrant procedure, but for the purpose
    * of the demo, whether it is or not is irrelevant */
 
-  if (!(dma->dma_irqs & (XLS_DMAIRQ_TSFRDONE | XLS_DMAIRQ_TLAST))) {
+  if (!(MMIO_READ(MMIO_DEV_XLS, dma->dma_irqs) &
+        (XLS_DMAIRQ_TSFRDONE | XLS_DMAIRQ_TLAST))) {
     return;
   }
 
-  for (int i = 0; i < dma->dma_ch_cnt; ++i) {
+  /* The channel count has been read by xls_dma_man_init */
+  for (uint32_t i = 0; i < dma_man->dman_ch_cnt; ++i) {
     xls_dma_chan_t* chan = &dma->dma_chans[i];
-    uint64_t irqs        = chan->dmach_irqs;
+    uint64_t irqs        = MMIO_READ(MMIO_DEV_XLS, chan->dmach_irqs);
+    if (irqs && !dma_man->dman_chan_data[i].dmanch_tsfr) {
+      /* Transfer has been cancelled */
+      MMIO_WRITE(MMIO_DEV_XLS, chan->dmach_irqs, 0xff);
+      continue;
+    }
     if (irqs & XLS_DMAIRQ_TSFRDONE) {
-      dma_man->dman_complete |= (1 << i);
+      dma_man->dman_complete |= XLS_DMA_CHAN_BIT(i);
       dma_man->dman_chan_data[i].dmanch_tsfr->tsfr_done = 1;
       dma_man->dman_chan_data[i].dmanch_tsfr->tsfr_transferred_bytes =
-          chan->dmach_tsfr_donelen;
+          MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
+      TRACE_EVENT(
+          TRACE_TSFR_COMPLETE, i,
+          dma_man->dman_chan_data[i].dmanch_tsfr->tsfr_transferred_bytes);
+      PERF_WORK_END(PERF_WORK_DMA(i));
     }
     if (irqs & XLS_DMAIRQ_TLAST) {
-      dma_man->dman_tlast |= (1 << i);
+      dma_man->dman_tlast |= XLS_DMA_CHAN_BIT(i);
     }
     if (irqs) {
       xls_dma_tsfr_t* tsfr = dma_man->dman_chan_data[i].dmanch_tsfr;
-      chan->dmach_irqs     = 0xff;
-      if (tsfr->tsfr_callback_isr) {
-        tsfr->tsfr_callback_isr(tsfr);
-      }
+      MMIO_WRITE(MMIO_DEV_XLS, chan->dmach_irqs, 0xff);
+      xls_dma_notify(tsfr);
+    }
+    if (irqs & XLS_DMAIRQ_TSFRDONE) {
+      /* Starts the next transfer queued on the channel, if there's one */
+      xls_dma_man_idle(dma_man, i);
     }
   }
 }
@@ -22,6 +22,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "common/mmio.h"
+#include "common/trace.h"
 #include "sys/_types.h"
 #include "sys/types.h"
 
@@ -49,11 +51,21 @@
 #define XLS_DMA_START_NOT_RDY               2
 #define XLS_DMA_TIMEOUT                     3
 #define XLS_DMA_NOMAN                       4
+#define XLS_DMA_NOMEM                       5
+#define XLS_DMA_BADPTR                      6
+#define XLS_DMA_DOUBLEFREE                  7
+#define XLS_DMA_PENDING                     8
+#define XLS_DMA_CANCELLED                   9
+#define XLS_DMA_NOCHAN                     10
+#define XLS_DMA_BADARG                     11
 #define XLS_DMA_UNIMPLEMENTED              -1
 // clang-format on
 
 #define TOKENCAT(x, y) x##y
 
+/* Bit of channel `ch` in the DMA and manager channel masks */
+#define XLS_DMA_CHAN_BIT(ch) ((uint64_t)1 << (ch))
+
 typedef struct __attribute__((packed, aligned(8))) xls_dma_chan {
   volatile uint64_t dmach_tsfr_base;
   volatile uint64_t dmach_tsfr_len;
@@ -81,7 +93,8 @@ typedef struct __attribute__((packed, aligned(8))) xls_dma {
 
 /* DEBUG-ONLY */
 static inline int xls_dma_ok(xls_dma_t* dma) {
-  return offsetof(xls_dma_t, dma_chans) == dma->dma_ch_first_offset;
+  return offsetof(xls_dma_t, dma_chans) ==
+         MMIO_READ(MMIO_DEV_XLS, dma->dma_ch_first_offset);
 }
 
 typedef enum xls_tsfr_dir {
@@ -91,14 +104,33 @@ typedef enum xls_tsfr_dir {
 
 struct xls_dma_tsfr;
 
+/* DMA manager, which tracks interrupt-driven transfers for the ISR and hands
+ * out the channels of a DMA (see xls_dma_man.h). It must be defined with
+ * XLS_DMA_MAN_DEFINE and initialized with `xls_dma_man_init`. */
 typedef struct xls_dma_man {
   uint64_t dman_complete;
   uint64_t dman_tlast;
+  xls_dma_t* dman_dma;
+  uint32_t dman_cap;         /* Capacity of `dman_chan_data` */
+  uint32_t dman_ch_cnt;      /* Channels managed, at most `dman_cap` */
+  uint64_t dman_from_periph; /* Channels moving data from the peripheral */
+  uint64_t dman_allocated;   /* Channels handed out by xls_dma_man_alloc */
+  volatile uint64_t dman_busy; /* Channels with a transfer in flight */
   struct {
-    struct xls_dma_tsfr* dmanch_tsfr;
+    struct xls_dma_tsfr* dmanch_tsfr; /* Current transfer */
+    struct xls_dma_tsfr* dmanch_head; /* Transfers waiting for the channel */
+    struct xls_dma_tsfr* dmanch_tail;
   } dman_chan_data[];
 } xls_dma_man_t;
 
+/* Defines a manager called `name` with room for `cap` channels. Any further
+ * arguments are applied as attributes (e.g. a section). */
+#define XLS_DMA_MAN_DEFINE(name, cap, ...)                     \
+  xls_dma_man_t name __VA_ARGS__ = {                           \
+      .dman_cap       = (cap),                                 \
+      .dman_chan_data = {[(cap) - 1] = {.dmanch_tsfr = NULL}}, \
+  }
+
 typedef void (*xls_dma_tsfr_callback_t)(struct xls_dma_tsfr*);
 
 typedef struct xls_dma_tsfr {
@@ -121,6 +153,14 @@ typedef struct xls_dma_tsfr {
   void* tsfr_ctx; /* Context for completion callback */
   xls_dma_tsfr_callback_t
       tsfr_callback_isr; /* Completion callback (called inside of an ISR!) */
+  volatile unsigned char tsfr_state; /* Maintained by the asynchronous API,
+                                      * see xls_dma_async.h */
+  unsigned char tsfr_final; /* Last segment of a request, always raises
+                             * an interrupt under a coalescing policy (see
+                             * xls_dma_session_coalesce) */
+  unsigned char tsfr_quiet; /* Set by sessions for interrupt-driven transfers
+                             * that don't raise the completion interrupt */
+  struct xls_dma_tsfr* tsfr_next; /* Next transfer queued on the channel */
 } xls_dma_tsfr_t;
 
 typedef enum xls_dma_irq {
@@ -129,11 +169,25 @@ typedef enum xls_dma_irq {
   XLS_DMAINT_RCVTLAST = 0x2,
 } xls_dma_irq_t;
 
+/* Runs the completion callback of a transfer, if there's one */
+static inline void xls_dma_notify(xls_dma_tsfr_t* tsfr) {
+  if (tsfr->tsfr_callback_isr) {
+    TRACE_EVENT(TRACE_CALLBACK_BEGIN, tsfr->tsfr_chan, 0);
+    tsfr->tsfr_callback_isr(tsfr);
+    TRACE_EVENT(TRACE_CALLBACK_END, tsfr->tsfr_chan, 0);
+  }
+}
+
 void xls_dma_poll_ready(const xls_dma_tsfr_t* tsfr);
 int xls_dma_begin_transfer(xls_dma_tsfr_t* tsfr);
 int xls_dma_complete_transfer(xls_dma_tsfr_t* tsfr, uint64_t timeout);
 void xls_dma_cancel_transfer(xls_dma_tsfr_t* tsfr);
 
+/* Completes a quiet transfer (`tsfr_quiet`) if the channel reports it as
+ * done. Returns 1 if the transfer is complete, whether it's been reaped here
+ * or completed by the ISR. */
+int xls_dma_reap_transfer(xls_dma_tsfr_t* tsfr);
+
 /* Call this inside of an ISR to handle an interrupt from DMA */
 void xls_dma_update_isr(xls_dma_t* dma, xls_dma_man_t* dma_man);
 
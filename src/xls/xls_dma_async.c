@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "xls_dma_async.h"
+
+#include "common/mmio.h"
+#include "common/perf_region.h"
+#include "common/sections.h"
+#include "cpu/riscv_csr.h"
+#include "xls_dma_man.h"
+
+static inline xls_dma_chan_t* get_tsfr_chan(xls_dma_tsfr_t* tsfr) {
+  return &tsfr->tsfr_dma->dma_chans[tsfr->tsfr_chan];
+}
+
+int xls_dma_submit(xls_dma_tsfr_t* tsfr, xls_dma_handle_t* handle) {
+  int err;
+
+  tsfr->tsfr_transferred_bytes = 0;
+  if ((err = xls_dma_begin_transfer(tsfr))) {
+    tsfr->tsfr_state = XLS_TSFR_IDLE;
+    return err;
+  }
+  tsfr->tsfr_state = XLS_TSFR_PENDING;
+  *handle          = tsfr;
+
+  return XLS_DMA_OK;
+}
+
+FAST_TEXT int xls_dma_test(xls_dma_handle_t tsfr) {
+  switch (tsfr->tsfr_state) {
+    case XLS_TSFR_DONE:
+      return XLS_DMA_OK;
+    case XLS_TSFR_CANCELLED:
+      return XLS_DMA_CANCELLED;
+    case XLS_TSFR_PENDING:
+      break;
+    default:
+      return XLS_DMA_OK;
+  }
+
+  if (tsfr->tsfr_polling) {
+    xls_dma_chan_t* chan = get_tsfr_chan(tsfr);
+    if (!(MMIO_READ(MMIO_DEV_XLS, chan->dmach_ctrl) &
+          XLS_DMACH_CTRL_TSFRDONE)) {
+      return XLS_DMA_PENDING;
+    }
+    tsfr->tsfr_transferred_bytes =
+        MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
+    tsfr->tsfr_done              = 1;
+    tsfr->tsfr_state             = XLS_TSFR_DONE;
+    TRACE_EVENT(TRACE_TSFR_COMPLETE, tsfr->tsfr_chan,
+                tsfr->tsfr_transferred_bytes);
+    PERF_WORK_END(PERF_WORK_DMA(tsfr->tsfr_chan));
+    xls_dma_notify(tsfr);
+    return XLS_DMA_OK;
+  }
+
+  if (tsfr->tsfr_quiet ? !xls_dma_reap_transfer(tsfr) : !tsfr->tsfr_done) {
+    return XLS_DMA_PENDING;
+  }
+  tsfr->tsfr_state = XLS_TSFR_DONE;
+  return XLS_DMA_OK;
+}
+
+int xls_dma_wait_any(const xls_dma_handle_t* handles, size_t cnt,
+                     uint64_t timeout, size_t* idx) {
+  do {
+    for (size_t i = 0; i < cnt; ++i) {
+      if (!handles[i]) continue;
+      int status = xls_dma_test(handles[i]);
+      if (status != XLS_DMA_PENDING) {
+        *idx = i;
+        return status;
+      }
+    }
+  } while (timeout == 0 || --timeout);
+
+  return XLS_DMA_TIMEOUT;
+}
+
+int xls_dma_wait_all(const xls_dma_handle_t* handles, size_t cnt,
+                     uint64_t timeout) {
+  do {
+    int pending   = 0;
+    int cancelled = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+      if (!handles[i]) continue;
+      int status = xls_dma_test(handles[i]);
+      pending |= status == XLS_DMA_PENDING;
+      cancelled |= status == XLS_DMA_CANCELLED;
+    }
+    if (!pending) {
+      return cancelled ? XLS_DMA_CANCELLED : XLS_DMA_OK;
+    }
+  } while (timeout == 0 || --timeout);
+
+  return XLS_DMA_TIMEOUT;
+}
+
+int xls_dma_cancel(xls_dma_handle_t tsfr) {
+  /* Keep the ISR from completing the transfer while it's being torn down */
+  uint32_t irq_state = rv32_irq_save();
+
+  if (xls_dma_test(tsfr) != XLS_DMA_PENDING) {
+    rv32_irq_restore(irq_state);
+    return XLS_DMA_OK;
+  }
+
+  /* A transfer still waiting in its channel's queue never reached the DMA */
+  if (!tsfr->tsfr_polling && xls_dma_man_unqueue(tsfr->tsfr_dma_man, tsfr)) {
+    tsfr->tsfr_transferred_bytes = 0;
+    tsfr->tsfr_done              = 1;
+    tsfr->tsfr_state             = XLS_TSFR_CANCELLED;
+    rv32_irq_restore(irq_state);
+    return XLS_DMA_OK;
+  }
+
+  xls_dma_chan_t* chan         = get_tsfr_chan(tsfr);
+  tsfr->tsfr_transferred_bytes =
+      MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
+  xls_dma_cancel_transfer(tsfr);
+  tsfr->tsfr_done  = 1;
+  tsfr->tsfr_state = XLS_TSFR_CANCELLED;
+  if (!tsfr->tsfr_polling) {
+    xls_dma_man_idle(tsfr->tsfr_dma_man, tsfr->tsfr_chan);
+  }
+
+  rv32_irq_restore(irq_state);
+  return XLS_DMA_OK;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __XLS_DMA_ASYNC_H__
+#define __XLS_DMA_ASYNC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xls_dma.h"
+
+/* Asynchronous transfer API.
+ *
+ * `xls_dma_submit` starts a transfer and returns immediately. Its progress can
+ * be checked with `xls_dma_test` or waited for with `xls_dma_wait_any` and
+ * `xls_dma_wait_all`, which allows doing other work while transfers are in
+ * flight. Works with both polled and interrupt-driven transfers. For polled
+ * transfers the completion callback is called from whichever of these
+ * functions first observes the completion, i.e. outside of an ISR.
+ *
+ * The caller owns the `xls_dma_tsfr_t` storage. It must stay valid and must
+ * not be modified from submission until `xls_dma_test` reports something other
+ * than XLS_DMA_PENDING.
+ *
+ * Cancellation stops the channel. The transfer is then considered finished
+ * with the XLS_DMA_CANCELLED status, `tsfr_transferred_bytes` holds the number
+ * of bytes transferred before the channel was stopped and the completion
+ * callback is NOT called. Cancelling a transfer that has already completed has
+ * no effect. */
+
+typedef enum xls_dma_tsfr_state {
+  XLS_TSFR_IDLE = 0,
+  XLS_TSFR_PENDING,
+  XLS_TSFR_DONE,
+  XLS_TSFR_CANCELLED,
+} xls_dma_tsfr_state_t;
+
+typedef xls_dma_tsfr_t* xls_dma_handle_t;
+
+/* Fails with XLS_DMA_START_NOT_RDY if the channel is still busy */
+int xls_dma_submit(xls_dma_tsfr_t* tsfr, xls_dma_handle_t* handle);
+
+/* Returns XLS_DMA_PENDING, XLS_DMA_OK or XLS_DMA_CANCELLED */
+int xls_dma_test(xls_dma_handle_t handle);
+
+/* Waits until any of the transfers finishes and stores its index in `idx`.
+ * NULL handles are skipped. `timeout` is a number of polling iterations, 0
+ * waits indefinitely. Returns the status of the finished transfer, or
+ * XLS_DMA_TIMEOUT. */
+int xls_dma_wait_any(const xls_dma_handle_t* handles, size_t cnt,
+                     uint64_t timeout, size_t* idx);
+
+/* Waits until all of the transfers finish. NULL handles are skipped. Returns
+ * XLS_DMA_OK, XLS_DMA_CANCELLED if any of the transfers has been cancelled, or
+ * XLS_DMA_TIMEOUT. */
+int xls_dma_wait_all(const xls_dma_handle_t* handles, size_t cnt,
+                     uint64_t timeout);
+
+static inline int xls_dma_wait(xls_dma_handle_t handle, uint64_t timeout) {
+  return xls_dma_wait_all(&handle, 1, timeout);
+}
+
+int xls_dma_cancel(xls_dma_handle_t handle);
+
+#endif /* __XLS_DMA_ASYNC_H__ */
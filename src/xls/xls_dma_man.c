@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "xls_dma_man.h"
+
+#include "common/mmio.h"
+#include "common/sections.h"
+#include "cpu/riscv_csr.h"
+
+int xls_dma_man_init(xls_dma_man_t* man, xls_dma_t* dma) {
+  uint64_t ch_cnt = MMIO_READ(MMIO_DEV_XLS, dma->dma_ch_cnt);
+
+  man->dman_dma         = dma;
+  man->dman_ch_cnt      = ch_cnt < man->dman_cap ? ch_cnt : man->dman_cap;
+  man->dman_complete    = 0;
+  man->dman_tlast       = 0;
+  man->dman_from_periph = 0;
+  man->dman_allocated   = 0;
+  man->dman_busy        = 0;
+
+  for (uint32_t i = 0; i < man->dman_ch_cnt; ++i) {
+    if (MMIO_READ(MMIO_DEV_XLS, dma->dma_chans[i].dmach_ctrl) &
+        XLS_DMACH_CTRL_DIR) {
+      man->dman_from_periph |= XLS_DMA_CHAN_BIT(i);
+    }
+    man->dman_chan_data[i].dmanch_tsfr = NULL;
+    man->dman_chan_data[i].dmanch_head = NULL;
+    man->dman_chan_data[i].dmanch_tail = NULL;
+  }
+
+  return XLS_DMA_OK;
+}
+
+int xls_dma_man_alloc(xls_dma_man_t* man, xls_tsf_dir_t dir, uint64_t* chan) {
+  uint64_t all = man->dman_ch_cnt < 64
+                     ? XLS_DMA_CHAN_BIT(man->dman_ch_cnt) - 1
+                     : ~(uint64_t)0;
+  uint64_t dir_mask = dir == XLS_TSFR_FROM_PERIPHERAL ? man->dman_from_periph
+                                                      : ~man->dman_from_periph;
+  uint64_t free = all & dir_mask & ~man->dman_allocated;
+  if (!free) return XLS_DMA_NOCHAN;
+
+  *chan = __builtin_ctzll(free);
+  man->dman_allocated |= XLS_DMA_CHAN_BIT(*chan);
+  return XLS_DMA_OK;
+}
+
+int xls_dma_man_free(xls_dma_man_t* man, uint64_t chan) {
+  if (chan >= man->dman_ch_cnt ||
+      !(man->dman_allocated & XLS_DMA_CHAN_BIT(chan))) {
+    return XLS_DMA_DOUBLEFREE;
+  }
+  if (xls_dma_man_busy(man, chan)) return XLS_DMA_PENDING;
+
+  man->dman_allocated &= ~XLS_DMA_CHAN_BIT(chan);
+  return XLS_DMA_OK;
+}
+
+FAST_TEXT void xls_dma_man_track(xls_dma_man_t* man, xls_dma_tsfr_t* tsfr) {
+  uint64_t bit = XLS_DMA_CHAN_BIT(tsfr->tsfr_chan);
+
+  /* The ISR updates the masks of other channels */
+  uint32_t irq_state = rv32_irq_save();
+  man->dman_chan_data[tsfr->tsfr_chan].dmanch_tsfr = tsfr;
+  man->dman_complete &= ~bit;
+  man->dman_tlast &= ~bit;
+  man->dman_busy |= bit;
+  rv32_irq_restore(irq_state);
+}
+
+FAST_TEXT void xls_dma_man_idle(xls_dma_man_t* man, uint64_t chan) {
+  /* The finished transfer may be gone by now, e.g. from the caller's stack,
+   * so late interrupts of the channel must not reach it */
+  man->dman_chan_data[chan].dmanch_tsfr = NULL;
+  man->dman_busy &= ~XLS_DMA_CHAN_BIT(chan);
+
+  xls_dma_tsfr_t* next;
+  while ((next = man->dman_chan_data[chan].dmanch_head)) {
+    man->dman_chan_data[chan].dmanch_head = next->tsfr_next;
+    if (!next->tsfr_next) man->dman_chan_data[chan].dmanch_tail = NULL;
+
+    xls_dma_handle_t handle;
+    if (xls_dma_submit(next, &handle) == XLS_DMA_OK) return;
+
+    /* The channel refused the transfer, it's finished as cancelled */
+    next->tsfr_done  = 1;
+    next->tsfr_state = XLS_TSFR_CANCELLED;
+  }
+}
+
+int xls_dma_man_unqueue(xls_dma_man_t* man, xls_dma_tsfr_t* tsfr) {
+  xls_dma_tsfr_t** link = &man->dman_chan_data[tsfr->tsfr_chan].dmanch_head;
+  xls_dma_tsfr_t* prev  = NULL;
+
+  while (*link && *link != tsfr) {
+    prev = *link;
+    link = &prev->tsfr_next;
+  }
+  if (!*link) return 0;
+
+  *link = tsfr->tsfr_next;
+  if (man->dman_chan_data[tsfr->tsfr_chan].dmanch_tail == tsfr) {
+    man->dman_chan_data[tsfr->tsfr_chan].dmanch_tail = prev;
+  }
+  return 1;
+}
+
+int xls_dma_man_submit(xls_dma_man_t* man, xls_dma_tsfr_t* tsfr,
+                       xls_dma_handle_t* handle) {
+  if (tsfr->tsfr_chan >= man->dman_ch_cnt) return XLS_DMA_NOCHAN;
+
+  tsfr->tsfr_dma     = man->dman_dma;
+  tsfr->tsfr_dma_man = man;
+  tsfr->tsfr_polling = 0;
+  tsfr->tsfr_next    = NULL;
+
+  uint32_t irq_state = rv32_irq_save();
+  int err            = XLS_DMA_OK;
+  if (xls_dma_man_busy(man, tsfr->tsfr_chan)) {
+    tsfr->tsfr_transferred_bytes = 0;
+    tsfr->tsfr_done              = 0;
+    tsfr->tsfr_quiet             = 0;
+    tsfr->tsfr_state             = XLS_TSFR_PENDING;
+    if (man->dman_chan_data[tsfr->tsfr_chan].dmanch_tail) {
+      man->dman_chan_data[tsfr->tsfr_chan].dmanch_tail->tsfr_next = tsfr;
+    } else {
+      man->dman_chan_data[tsfr->tsfr_chan].dmanch_head = tsfr;
+    }
+    man->dman_chan_data[tsfr->tsfr_chan].dmanch_tail = tsfr;
+    *handle                                          = tsfr;
+  } else {
+    err = xls_dma_submit(tsfr, handle);
+  }
+  rv32_irq_restore(irq_state);
+
+  return err;
+}
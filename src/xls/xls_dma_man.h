@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __XLS_DMA_MAN_H__
+#define __XLS_DMA_MAN_H__
+
+#include <stdint.h>
+
+#include "xls_dma.h"
+#include "xls_dma_async.h"
+
+/* DMA manager.
+ *
+ * A manager covers the channels of one DMA. `xls_dma_man_init` reads their
+ * number from `dma_ch_cnt` (up to the capacity the manager has been defined
+ * with) and the direction of every channel from its control register, so
+ * users ask for a channel moving data in a given direction with
+ * `xls_dma_man_alloc` instead of hardcoding channel numbers.
+ *
+ * Every channel has a busy bit in `dman_busy`, set while an interrupt-driven
+ * transfer is in flight on it. Transfers submitted with `xls_dma_man_submit`
+ * start right away on an idle channel and are queued behind the current
+ * transfer on a busy one. When a transfer completes, the ISR starts the next
+ * one queued on its channel, so independent channels run in parallel and
+ * transfers on a single channel run back to back without the caller waiting
+ * in between. Queued transfers are tested, waited for and cancelled with the
+ * asynchronous API. A channel should be driven either through the queue or
+ * through a session (xls_dma_session.h), not both at once. A session whose
+ * channel has been used through the queue must be resynchronized with
+ * `xls_dma_session_sync` before its next transfer. */
+
+int xls_dma_man_init(xls_dma_man_t* man, xls_dma_t* dma);
+
+/* Allocates a free channel moving data in `dir`. Returns XLS_DMA_NOCHAN if
+ * there's none left. */
+int xls_dma_man_alloc(xls_dma_man_t* man, xls_tsf_dir_t dir, uint64_t* chan);
+
+/* Returns XLS_DMA_DOUBLEFREE if the channel isn't allocated and
+ * XLS_DMA_PENDING if it still has transfers in flight */
+int xls_dma_man_free(xls_dma_man_t* man, uint64_t chan);
+
+static inline int xls_dma_man_busy(const xls_dma_man_t* man, uint64_t chan) {
+  return !!(man->dman_busy & XLS_DMA_CHAN_BIT(chan));
+}
+
+/* Submits an interrupt-driven transfer on `tsfr_chan` of the manager's DMA.
+ * The DMA, polling and manager fields of `tsfr` are set by the manager. */
+int xls_dma_man_submit(xls_dma_man_t* man, xls_dma_tsfr_t* tsfr,
+                       xls_dma_handle_t* handle);
+
+/* Driver internals. `xls_dma_man_track` marks the channel of `tsfr` as busy
+ * with it when the transfer is started. `xls_dma_man_idle` detaches the
+ * finished transfer from the channel, marks the channel as idle and starts
+ * the next queued one, it must be called with interrupts masked. */
+void xls_dma_man_track(xls_dma_man_t* man, xls_dma_tsfr_t* tsfr);
+void xls_dma_man_idle(xls_dma_man_t* man, uint64_t chan);
+
+/* Removes a transfer that hasn't been started yet from its channel's queue.
+ * Returns 0 if it isn't queued. Must be called with interrupts masked. */
+int xls_dma_man_unqueue(xls_dma_man_t* man, xls_dma_tsfr_t* tsfr);
+
+#endif /* __XLS_DMA_MAN_H__ */
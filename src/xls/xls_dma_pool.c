@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "xls_dma_pool.h"
+
+#include "cpu/riscv_csr.h"
+
+typedef struct xls_dma_pool_node {
+  struct xls_dma_pool_node* next;
+} xls_dma_pool_node_t;
+
+static inline int block_index(const xls_dma_pool_t* pool, const void* block,
+                              size_t* idx) {
+  const uint8_t* ptr = (const uint8_t*)block;
+  if (ptr < pool->pool_mem) return 0;
+
+  size_t offset = ptr - pool->pool_mem;
+  if (offset % pool->pool_stride) return 0;
+
+  *idx = offset / pool->pool_stride;
+  return *idx < pool->pool_block_cnt;
+}
+
+void xls_dma_pool_init(xls_dma_pool_t* pool) {
+  xls_dma_pool_node_t* head = NULL;
+
+  /* Push in reverse, so that blocks are handed out in address order */
+  for (size_t i = pool->pool_block_cnt; i > 0; --i) {
+    xls_dma_pool_node_t* node =
+        (xls_dma_pool_node_t*)(pool->pool_mem + (i - 1) * pool->pool_stride);
+    node->next = head;
+    head       = node;
+  }
+  for (size_t i = 0; i < (pool->pool_block_cnt + 31) / 32; ++i) {
+    pool->pool_used[i] = 0;
+  }
+
+  pool->pool_free   = head;
+  pool->pool_in_use = 0;
+  pool->pool_peak   = 0;
+}
+
+void* xls_dma_pool_alloc(xls_dma_pool_t* pool) {
+  uint32_t irq_state = rv32_irq_save();
+
+  xls_dma_pool_node_t* node = pool->pool_free;
+  if (node) {
+    size_t idx = ((uint8_t*)node - pool->pool_mem) / pool->pool_stride;
+    pool->pool_free = node->next;
+    pool->pool_used[idx / 32] |= (uint32_t)1 << (idx % 32);
+    if (++pool->pool_in_use > pool->pool_peak) {
+      pool->pool_peak = pool->pool_in_use;
+    }
+  }
+
+  rv32_irq_restore(irq_state);
+  return node;
+}
+
+int xls_dma_pool_free(xls_dma_pool_t* pool, void* block) {
+  size_t idx;
+  if (!block_index(pool, block, &idx)) return XLS_DMA_BADPTR;
+
+  uint32_t bit       = (uint32_t)1 << (idx % 32);
+  uint32_t irq_state = rv32_irq_save();
+
+  if (!(pool->pool_used[idx / 32] & bit)) {
+    rv32_irq_restore(irq_state);
+    return XLS_DMA_DOUBLEFREE;
+  }
+
+  xls_dma_pool_node_t* node = (xls_dma_pool_node_t*)block;
+  node->next                = pool->pool_free;
+  pool->pool_free           = node;
+  pool->pool_used[idx / 32] &= ~bit;
+  --pool->pool_in_use;
+
+  rv32_irq_restore(irq_state);
+  return XLS_DMA_OK;
+}
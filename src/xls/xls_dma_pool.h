@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __XLS_DMA_POOL_H__
+#define __XLS_DMA_POOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xls_dma.h"
+
+/* Fixed-block allocator for DMA-capable buffers.
+ *
+ * Every block starts at a multiple of the pool alignment and is at least
+ * `block_size` bytes long. Free blocks are kept on an intrusive singly-linked
+ * list, so both allocation and release are O(1). Each block also has a bit in
+ * the `pool_used` bitmap, which lets `xls_dma_pool_free` reject pointers that
+ * don't belong to the pool or that have already been released.
+ *
+ * Both `xls_dma_pool_alloc` and `xls_dma_pool_free` mask interrupts for
+ * the duration of the list update, so they can be called from transfer
+ * completion callbacks running inside of an ISR. */
+
+#define XLS_DMA_POOL_STRIDE(size, align) \
+  (((size) + (align) - 1) & ~((size_t)(align) - 1))
+
+typedef struct xls_dma_pool {
+  uint8_t* pool_mem;        /* Backing memory, aligned to `pool_align` */
+  size_t pool_stride;       /* Distance between blocks (aligned block size) */
+  size_t pool_align;        /* Block alignment, power of two */
+  size_t pool_block_cnt;    /* Total number of blocks */
+  uint32_t* pool_used;      /* One bit per block, set when allocated */
+  void* pool_free;          /* Head of the free list */
+  size_t pool_in_use;       /* Number of currently allocated blocks */
+  size_t pool_peak;         /* Highest value `pool_in_use` has reached */
+} xls_dma_pool_t;
+
+/* Defines a pool called `name` with `count` blocks of at least `size` bytes,
+ * each aligned to `align` bytes. `align` must be a power of two not smaller
+ * than `sizeof(void*)`. Any further arguments are applied as attributes of
+ * the backing memory (e.g. a section). The pool has to be initialized with
+ * `xls_dma_pool_init` before use. */
+#define XLS_DMA_POOL_DEFINE(name, size, count, align, ...)            \
+  static uint8_t TOKENCAT(name, _mem)[XLS_DMA_POOL_STRIDE(size, align) * \
+                                      (count)]                        \
+      __attribute__((aligned(align))) __VA_ARGS__;                    \
+  static uint32_t TOKENCAT(name, _used)[((count) + 31) / 32];         \
+  xls_dma_pool_t name = {                                             \
+      .pool_mem       = TOKENCAT(name, _mem),                         \
+      .pool_stride    = XLS_DMA_POOL_STRIDE(size, align),             \
+      .pool_align     = (align),                                      \
+      .pool_block_cnt = (count),                                      \
+      .pool_used      = TOKENCAT(name, _used),                        \
+  }
+
+/* Builds the free list. Any blocks allocated before the call are lost. */
+void xls_dma_pool_init(xls_dma_pool_t* pool);
+
+/* Returns NULL if the pool is exhausted */
+void* xls_dma_pool_alloc(xls_dma_pool_t* pool);
+int xls_dma_pool_free(xls_dma_pool_t* pool, void* block);
+
+static inline size_t xls_dma_pool_block_size(const xls_dma_pool_t* pool) {
+  return pool->pool_stride;
+}
+
+#endif /* __XLS_DMA_POOL_H__ */
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "xls_dma_ring.h"
+
+#include <string.h>
+
+#include "common/mmio.h"
+#include "common/sections.h"
+#include "xls_dma_man.h"
+
+int xls_dma_ring_init(xls_dma_ring_t* ring, xls_dma_session_t* sess,
+                      uint8_t* mem, size_t slot_size, uint32_t slot_cnt,
+                      xls_dma_ring_callback_t callback, void* ctx,
+                      const xls_dma_tsfr_t* proto) {
+  if (!mem) return XLS_DMA_BADPTR;
+  if (!slot_size || !slot_cnt || slot_cnt > XLS_DMA_RING_MAX_SLOTS) {
+    return XLS_DMA_BADARG;
+  }
+
+  memset(ring, 0, sizeof(*ring));
+  ring->ring_sess      = sess;
+  ring->ring_mem       = mem;
+  ring->ring_slot_size = slot_size;
+  ring->ring_slot_cnt  = slot_cnt;
+  ring->ring_callback  = callback;
+  ring->ring_ctx       = ctx;
+  for (int i = 0; i < 2; ++i) {
+    ring->ring_tsfr[i].tsfr_dir = sess->sess_dir;
+    if (proto) {
+      ring->ring_tsfr[i].tsfr_callback_isr = proto->tsfr_callback_isr;
+      ring->ring_tsfr[i].tsfr_ctx          = proto->tsfr_ctx;
+    }
+  }
+
+  return XLS_DMA_OK;
+}
+
+static int ring_submit(xls_dma_ring_t* ring, xls_dma_tsfr_t* tsfr,
+                       xls_dma_handle_t* handle) {
+  xls_dma_man_t* dma_man = ring->ring_sess->sess_dma_man;
+
+  if (!ring->ring_active) xls_dma_poll_ready(tsfr);
+  if (!dma_man) {
+    return xls_dma_session_submit(ring->ring_sess, tsfr, handle);
+  }
+  /* Queued behind the transfer in flight, if there's one */
+  return xls_dma_man_submit(dma_man, tsfr, handle);
+}
+
+/* Arms the free slots past the ones covered by transfers, with the first
+ * transfer if the channel is idle or with a follow-on transfer queued behind
+ * the one in flight */
+static int ring_arm(xls_dma_ring_t* ring) {
+  if (ring->ring_stopped) return XLS_DMA_OK;
+  if (ring->ring_active &&
+      (ring->ring_queued || !ring->ring_sess->sess_dma_man)) {
+    return XLS_DMA_OK;
+  }
+
+  uint32_t pending = ring->ring_armed - ring->ring_seen + ring->ring_queued;
+  uint32_t free    = ring->ring_slot_cnt - ring->ring_ready - pending;
+  if (!free) return XLS_DMA_OK;
+
+  /* Stop at the end of the ring, the rest is armed from slot 0 next time */
+  uint32_t pos    = (ring->ring_head + pending) % ring->ring_slot_cnt;
+  uint32_t to_end = ring->ring_slot_cnt - pos;
+  uint32_t slots  = free < to_end ? free : to_end;
+  if (slots < free) ++ring->ring_wraps;
+
+  int idx              = ring->ring_cur ^ ring->ring_active;
+  xls_dma_tsfr_t* tsfr = &ring->ring_tsfr[idx];
+  tsfr->tsfr_data      = ring->ring_mem + (size_t)pos * ring->ring_slot_size;
+  tsfr->tsfr_len       = (uint64_t)slots * ring->ring_slot_size;
+  tsfr->tsfr_final     = 0;
+
+  int err;
+  if ((err = ring_submit(ring, tsfr, &ring->ring_handle[idx]))) {
+    return err;
+  }
+  ++ring->ring_tsfrs;
+  if (ring->ring_active) {
+    ring->ring_queued = slots;
+    return XLS_DMA_OK;
+  }
+  ring->ring_armed  = slots;
+  ring->ring_seen   = 0;
+  ring->ring_live   = 0;
+  ring->ring_active = 1;
+  return XLS_DMA_OK;
+}
+
+int xls_dma_ring_start(xls_dma_ring_t* ring) {
+  for (int i = 0; i < 2; ++i) {
+    ring->ring_tsfr[i].tsfr_dma  = ring->ring_sess->sess_dma;
+    ring->ring_tsfr[i].tsfr_chan = ring->ring_sess->sess_chan;
+  }
+  ring->ring_stopped = 0;
+
+  int err;
+  if ((err = ring_arm(ring))) return err;
+  /* Queues the slots from 0 if the first transfer stopped at the end */
+  return ring_arm(ring);
+}
+
+static void ring_hand_out(xls_dma_ring_t* ring, size_t len) {
+  uint32_t slot = ring->ring_head;
+
+  ring->ring_slot_len[slot] = len;
+  ring->ring_head           = (slot + 1) % ring->ring_slot_cnt;
+  ++ring->ring_ready;
+  ++ring->ring_seen;
+  ring->ring_bytes += len;
+
+  ring->ring_callback(ring->ring_ctx,
+                      ring->ring_mem + (size_t)slot * ring->ring_slot_size,
+                      len);
+}
+
+/* Bytes written by the transfer in flight so far, as far as the DMA reports
+ * them before completion */
+static uint64_t ring_progress(xls_dma_ring_t* ring) {
+  const xls_dma_chan_t* chan =
+      &ring->ring_sess->sess_dma->dma_chans[ring->ring_sess->sess_chan];
+  return MMIO_READ(MMIO_DEV_XLS, chan->dmach_tsfr_donelen);
+}
+
+FAST_TEXT int xls_dma_ring_poll(xls_dma_ring_t* ring) {
+  while (ring->ring_active) {
+    xls_dma_tsfr_t* tsfr = &ring->ring_tsfr[ring->ring_cur];
+    int status           = xls_dma_test(ring->ring_handle[ring->ring_cur]);
+    uint64_t bytes       = status == XLS_DMA_PENDING
+                               ? ring_progress(ring)
+                               : tsfr->tsfr_transferred_bytes;
+
+    uint32_t full = bytes / ring->ring_slot_size;
+    if (full > ring->ring_armed) full = ring->ring_armed;
+    while (ring->ring_seen < full) {
+      ring_hand_out(ring, ring->ring_slot_size);
+    }
+    if (status == XLS_DMA_PENDING) {
+      if (bytes) ring->ring_live = 1;
+      return XLS_DMA_PENDING;
+    }
+    if (ring->ring_live) ++ring->ring_live_tsfrs;
+
+    /* The transfer ended before filling all of its slots */
+    size_t rest = bytes - (uint64_t)ring->ring_seen * ring->ring_slot_size;
+    if (rest && ring->ring_seen < ring->ring_armed) {
+      ring_hand_out(ring, rest);
+    }
+    if (!ring->ring_queued) {
+      ring->ring_active = 0;
+      break;
+    }
+
+    /* The follow-on transfer writes past the slots this one didn't reach */
+    while (ring->ring_seen < ring->ring_armed) {
+      ring_hand_out(ring, 0);
+    }
+    ring->ring_cur ^= 1;
+    ring->ring_armed  = ring->ring_queued;
+    ring->ring_queued = 0;
+    ring->ring_seen   = 0;
+    ring->ring_live   = 0;
+    ring_arm(ring);
+  }
+
+  ring_arm(ring);
+  return ring->ring_active ? XLS_DMA_PENDING : XLS_DMA_OK;
+}
+
+void xls_dma_ring_release(xls_dma_ring_t* ring) {
+  if (!ring->ring_ready) return;
+
+  ring->ring_tail = (ring->ring_tail + 1) % ring->ring_slot_cnt;
+  --ring->ring_ready;
+  ring_arm(ring);
+}
+
+void xls_dma_ring_stop(xls_dma_ring_t* ring, uint64_t timeout) {
+  uint64_t done = ring->ring_bytes;
+  uint64_t idle = 0;
+
+  while (xls_dma_ring_poll(ring) == XLS_DMA_PENDING) {
+    uint64_t progress = ring->ring_bytes + ring_progress(ring);
+    if (progress != done) {
+      done = progress;
+      idle = 0;
+    } else if (++idle >= timeout) {
+      ring->ring_stopped = 1;
+      /* Cancelling the transfer in flight first would start the queued one */
+      if (ring->ring_queued) {
+        xls_dma_cancel(ring->ring_handle[ring->ring_cur ^ 1]);
+      }
+      xls_dma_cancel(ring->ring_handle[ring->ring_cur]);
+      xls_dma_ring_poll(ring);
+      break;
+    }
+  }
+  ring->ring_stopped = 1;
+
+  /* Transfers started through the manager bypassed the session */
+  if (ring->ring_sess->sess_dma_man) {
+    xls_dma_session_sync(ring->ring_sess);
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __XLS_DMA_RING_H__
+#define __XLS_DMA_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xls_dma.h"
+#include "xls_dma_async.h"
+#include "xls_dma_session.h"
+
+/* Receive ring.
+ *
+ * Data coming from a peripheral is written into a ring of `ring_slot_cnt`
+ * slots of `ring_slot_size` bytes each. The channel is armed with a single
+ * transfer covering all free slots from the write position, so the DMA keeps
+ * writing while the consumer works on earlier slots. A transfer never spans
+ * the end of the ring: if the free slots wrap around, the transfer stops at
+ * the last slot and the next one starts from slot 0.
+ *
+ * Slots are released by the consumer in the order they were handed out,
+ * either from the callback or later. On an interrupt-driven session, slots
+ * released while a transfer is in flight are covered by a follow-on transfer,
+ * queued behind it on the DMA manager (xls_dma_man.h) and started by the ISR
+ * as soon as it completes, so the channel keeps writing across the ring. On
+ * a polled session, released slots are armed once the channel is idle.
+ *
+ * `xls_dma_ring_poll` follows the progress of the transfer in flight through
+ * `dmach_tsfr_donelen` and hands every slot out to the callback as soon as
+ * it's full, without waiting for the whole transfer. This relies on the DMA
+ * updating the done length while the transfer is running, which the register
+ * interface doesn't guarantee. A DMA that only sets it on completion still
+ * works, but slots are then handed out once their transfer completes or the
+ * ring is stopped. `ring_live_tsfrs` counts the transfers whose progress was
+ * seen while they were in flight, so the two cases can be told apart at
+ * runtime. A transfer that ends early (the peripheral sent TLAST, or the
+ * ring has been stopped) hands out its last slot partially filled, and the
+ * slots it didn't reach empty if a follow-on transfer is queued behind it.
+ *
+ * The ring drives the channel through `sess`, polled or interrupt-driven,
+ * which must not be used for anything else while the ring is running.
+ * Interrupt-driven rings start their transfers through the DMA manager and
+ * resynchronize `sess` when stopped. Callbacks run from `xls_dma_ring_poll`
+ * and `xls_dma_ring_stop`, never from an ISR. */
+
+#define XLS_DMA_RING_MAX_SLOTS 32
+
+typedef void (*xls_dma_ring_callback_t)(void* ctx, uint8_t* data, size_t len);
+
+typedef struct xls_dma_ring {
+  xls_dma_session_t* ring_sess;
+  uint8_t* ring_mem;
+  size_t ring_slot_size;
+  uint32_t ring_slot_cnt;
+  uint32_t ring_head;  /* Next slot to be handed out */
+  uint32_t ring_tail;  /* Oldest slot not released yet */
+  uint32_t ring_ready; /* Slots handed out and not released yet */
+  uint32_t ring_armed; /* Slots covered by the transfer in flight */
+  uint32_t ring_seen;  /* Of which already handed out */
+  uint32_t ring_queued; /* Slots covered by the follow-on transfer */
+  uint8_t ring_cur;     /* Transfer in flight, the other one is queued */
+  uint8_t ring_active;
+  uint8_t ring_stopped;
+  uint8_t ring_live; /* Progress of the transfer in flight has been seen */
+  xls_dma_tsfr_t ring_tsfr[2];
+  xls_dma_handle_t ring_handle[2];
+  xls_dma_ring_callback_t ring_callback;
+  void* ring_ctx;
+  uint32_t ring_slot_len[XLS_DMA_RING_MAX_SLOTS]; /* Bytes in handed out
+                                                   * slots */
+  uint64_t ring_bytes;      /* Bytes received since init */
+  uint32_t ring_tsfrs;      /* Transfers started since init */
+  uint32_t ring_wraps;      /* Transfers cut short at the end of the ring */
+  uint32_t ring_live_tsfrs; /* Transfers with progress seen in flight */
+} xls_dma_ring_t;
+
+/* `mem` holds `slot_cnt` slots of `slot_size` bytes. Completion callbacks of
+ * the ring transfers are taken from `tsfr_callback_isr` and `tsfr_ctx` of
+ * `proto`, which may be NULL. Doesn't start the ring. Returns XLS_DMA_BADPTR
+ * if `mem` is NULL and XLS_DMA_BADARG for an invalid ring geometry. */
+int xls_dma_ring_init(xls_dma_ring_t* ring, xls_dma_session_t* sess,
+                      uint8_t* mem, size_t slot_size, uint32_t slot_cnt,
+                      xls_dma_ring_callback_t callback, void* ctx,
+                      const xls_dma_tsfr_t* proto);
+
+/* Arms the channel */
+int xls_dma_ring_start(xls_dma_ring_t* ring);
+
+/* Hands out filled slots and re-arms the channel. Returns
+ * XLS_DMA_PENDING while a transfer is in flight, XLS_DMA_OK if the ring is
+ * idle (all slots are waiting to be released, or the ring is stopped). */
+int xls_dma_ring_poll(xls_dma_ring_t* ring);
+
+/* Releases the oldest slot handed out */
+void xls_dma_ring_release(xls_dma_ring_t* ring);
+
+/* Stops the ring once the peripheral stops sending data, i.e. after
+ * `timeout` polling iterations without progress. The transfer in flight is
+ * cancelled and the data it has received is handed out. */
+void xls_dma_ring_stop(xls_dma_ring_t* ring, uint64_t timeout);
+
+#endif /* __XLS_DMA_RING_H__ */
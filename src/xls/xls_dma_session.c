@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "xls_dma_session.h"
+
+#include "common/mmio.h"
+#include "common/perf_region.h"
+#include "common/sections.h"
+#include "xls_dma_man.h"
+
+static inline xls_dma_chan_t* get_sess_chan(xls_dma_session_t* sess) {
+  return &sess->sess_dma->dma_chans[sess->sess_chan];
+}
+
+/* 64-bit registers are written as two 32-bit halves on rv32 anyway, this only
+ * skips the halves that already hold the right value. */
+static inline void write_reg64(volatile uint64_t* reg, uint32_t cache[2],
+                               uint64_t val) {
+  volatile uint32_t* halves = (volatile uint32_t*)reg;
+  uint32_t lo               = (uint32_t)val;
+  uint32_t hi               = (uint32_t)(val >> 32);
+  if (cache[0] != lo) {
+    MMIO_WRITE(MMIO_DEV_XLS, halves[0], lo);
+    cache[0] = lo;
+  }
+  if (cache[1] != hi) {
+    MMIO_WRITE(MMIO_DEV_XLS, halves[1], hi);
+    cache[1] = hi;
+  }
+}
+
+int xls_dma_session_open(xls_dma_session_t* sess, xls_dma_t* dma,
+                         uint64_t chan, xls_tsf_dir_t dir,
+                         xls_dma_man_t* dma_man) {
+  xls_dma_chan_t* dma_chan = &dma->dma_chans[chan];
+
+  MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_ctrl, 0);
+
+  int valid_dir =
+      MMIO_READ(MMIO_DEV_XLS, dma_chan->dmach_ctrl) & XLS_DMACH_CTRL_DIR
+          ? (dir == XLS_TSFR_FROM_PERIPHERAL)
+          : (dir == XLS_TSFR_TO_PERIPHERAL);
+  if (!valid_dir) return XLS_DMA_START_WRONGDIR;
+
+  sess->sess_dma       = dma;
+  sess->sess_chan      = chan;
+  sess->sess_dir       = dir;
+  sess->sess_dma_man   = dma_man;
+  sess->sess_ctrl      = XLS_DMACH_CTRL_MODE;
+  sess->sess_irq_every = 1;
+  sess->sess_irq_cnt   = 0;
+  sess->sess_irq_tlast = 0;
+
+  if (dma_man) {
+    MMIO_SET(MMIO_DEV_XLS, dma->dma_irq_mask, XLS_DMA_CHAN_BIT(chan));
+    sess->sess_ctrl |= XLS_DMACH_CTRL_IRQMASK_TSFRDONE;
+  } else {
+    MMIO_SET(MMIO_DEV_XLS, dma_chan->dmach_irqs, -1);
+    MMIO_CLEAR(MMIO_DEV_XLS, dma->dma_irq_mask, XLS_DMA_CHAN_BIT(chan));
+  }
+  MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_ctrl, sess->sess_ctrl);
+
+  /* Start from known register values */
+  MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_tsfr_base, 0);
+  MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_tsfr_len, 0);
+  sess->sess_base[0] = sess->sess_base[1] = 0;
+  sess->sess_len[0] = sess->sess_len[1] = 0;
+
+  return XLS_DMA_OK;
+}
+
+void xls_dma_session_coalesce(xls_dma_session_t* sess, uint32_t every,
+                              int tlast) {
+  sess->sess_irq_every = every;
+  sess->sess_irq_cnt   = 0;
+  sess->sess_irq_tlast = !!tlast;
+}
+
+FAST_TEXT int xls_dma_session_begin(xls_dma_session_t* sess,
+                                    xls_dma_tsfr_t* tsfr) {
+  xls_dma_chan_t* dma_chan = get_sess_chan(sess);
+
+  tsfr->tsfr_dma     = sess->sess_dma;
+  tsfr->tsfr_chan    = sess->sess_chan;
+  tsfr->tsfr_dir     = sess->sess_dir;
+  tsfr->tsfr_ignore  = 0;
+  tsfr->tsfr_polling = !sess->sess_dma_man;
+  tsfr->tsfr_dma_man = sess->sess_dma_man;
+  tsfr->tsfr_quiet   = 0;
+
+  uint32_t ctrl = sess->sess_ctrl;
+  if (sess->sess_dma_man) {
+    xls_dma_man_track(sess->sess_dma_man, tsfr);
+
+    if (++sess->sess_irq_cnt < sess->sess_irq_every && !tsfr->tsfr_final) {
+      ctrl &= ~XLS_DMACH_CTRL_IRQMASK_TSFRDONE;
+      if (sess->sess_irq_tlast) ctrl |= XLS_DMACH_CTRL_IRQMASK_LAST;
+      tsfr->tsfr_quiet = 1;
+    } else {
+      sess->sess_irq_cnt = 0;
+    }
+  }
+
+  write_reg64(&dma_chan->dmach_tsfr_base, sess->sess_base,
+              (size_t)tsfr->tsfr_data);
+  write_reg64(&dma_chan->dmach_tsfr_len, sess->sess_len, tsfr->tsfr_len);
+
+  tsfr->tsfr_done = 0;
+  TRACE_EVENT(TRACE_TSFR_BEGIN, tsfr->tsfr_chan, tsfr->tsfr_len);
+  PERF_WORK_BEGIN(PERF_WORK_DMA(tsfr->tsfr_chan));
+  MMIO_WRITE(MMIO_DEV_XLS, dma_chan->dmach_ctrl, ctrl | XLS_DMACH_CTRL_TSFR);
+
+  return XLS_DMA_OK;
+}
+
+FAST_TEXT int xls_dma_session_submit(xls_dma_session_t* sess,
+                                     xls_dma_tsfr_t* tsfr,
+                                     xls_dma_handle_t* handle) {
+  tsfr->tsfr_transferred_bytes = 0;
+  xls_dma_session_begin(sess, tsfr);
+  tsfr->tsfr_state = XLS_TSFR_PENDING;
+  *handle          = tsfr;
+
+  return XLS_DMA_OK;
+}
+
+void xls_dma_session_sync(xls_dma_session_t* sess) {
+  xls_dma_chan_t* dma_chan = get_sess_chan(sess);
+  volatile uint32_t* base  = (volatile uint32_t*)&dma_chan->dmach_tsfr_base;
+  volatile uint32_t* len   = (volatile uint32_t*)&dma_chan->dmach_tsfr_len;
+
+  sess->sess_base[0] = MMIO_READ(MMIO_DEV_XLS, base[0]);
+  sess->sess_base[1] = MMIO_READ(MMIO_DEV_XLS, base[1]);
+  sess->sess_len[0]  = MMIO_READ(MMIO_DEV_XLS, len[0]);
+  sess->sess_len[1]  = MMIO_READ(MMIO_DEV_XLS, len[1]);
+}
+
+void xls_dma_session_close(xls_dma_session_t* sess) {
+  MMIO_WRITE(MMIO_DEV_XLS, get_sess_chan(sess)->dmach_ctrl, 0);
+  MMIO_CLEAR(MMIO_DEV_XLS, sess->sess_dma->dma_irq_mask,
+             XLS_DMA_CHAN_BIT(sess->sess_chan));
+}
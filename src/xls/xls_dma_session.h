@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2023-2024 Antmicro
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __XLS_DMA_SESSION_H__
+#define __XLS_DMA_SESSION_H__
+
+#include <stdint.h>
+
+#include "xls_dma.h"
+#include "xls_dma_async.h"
+
+/* Persistent channel sessions.
+ *
+ * `xls_dma_begin_transfer` validates the channel and configures its IRQ mask
+ * and mode on every transfer, with several read-modify-write cycles on the
+ * control register. A session does it once, when the channel is opened, and
+ * keeps the resulting control word and the last values written to the base
+ * and length registers. Starting a transfer on an open session then only
+ * writes the 32-bit halves of base and length that have changed, followed by
+ * a single write of the control register.
+ *
+ * Transfers started through a session always use data mode (`tsfr_ignore` is
+ * not supported) and their DMA, channel, direction, polling and manager
+ * fields are taken from the session. The caller must make sure that the
+ * channel is ready (e.g. with `xls_dma_poll_ready`), as the RDY bit is not
+ * checked. Transfers are completed with the regular or asynchronous API.
+ *
+ * Interrupt-driven sessions can coalesce completion interrupts (see
+ * `xls_dma_session_coalesce`). Transfers that don't raise the interrupt are
+ * marked with `tsfr_quiet` and are reaped by polling the channel from
+ * `xls_dma_test` and `xls_dma_complete_transfer`, as the caller waits for them
+ * anyway before submitting the next one. */
+
+typedef struct xls_dma_session {
+  xls_dma_t* sess_dma;
+  uint64_t sess_chan;
+  xls_tsf_dir_t sess_dir;
+  xls_dma_man_t* sess_dma_man; /* NULL for polled transfers */
+  uint32_t sess_ctrl;          /* Control word, without the TSFR bit */
+  uint32_t sess_base[2];       /* Last written halves of dmach_tsfr_base */
+  uint32_t sess_len[2];        /* Last written halves of dmach_tsfr_len */
+  uint32_t sess_irq_every;     /* See xls_dma_session_coalesce */
+  uint32_t sess_irq_cnt;       /* Transfers since the last interrupt */
+  uint8_t sess_irq_tlast;
+} xls_dma_session_t;
+
+/* Validates the direction of the channel and configures it. Transfers use
+ * interrupts if `dma_man` is non-NULL and polling otherwise. */
+int xls_dma_session_open(xls_dma_session_t* sess, xls_dma_t* dma,
+                         uint64_t chan, xls_tsf_dir_t dir,
+                         xls_dma_man_t* dma_man);
+
+/* Interrupt coalescing policy. Only every `every`-th transfer and transfers
+ * with `tsfr_final` set raise the completion interrupt, the others complete
+ * quietly. With `tlast`, quiet transfers still interrupt when the peripheral
+ * ends the packet with TLAST. `every` of 0 or 1 (the default) raises the
+ * interrupt on every transfer. Has no effect on polled sessions. */
+void xls_dma_session_coalesce(xls_dma_session_t* sess, uint32_t every,
+                              int tlast);
+
+/* Counterpart of `xls_dma_begin_transfer` */
+int xls_dma_session_begin(xls_dma_session_t* sess, xls_dma_tsfr_t* tsfr);
+
+/* Counterpart of `xls_dma_submit` */
+int xls_dma_session_submit(xls_dma_session_t* sess, xls_dma_tsfr_t* tsfr,
+                           xls_dma_handle_t* handle);
+
+/* Reloads the base and length values kept by the session from the channel
+ * registers, after transfers have been started on the channel outside of the
+ * session (e.g. with `xls_dma_man_submit`) */
+void xls_dma_session_sync(xls_dma_session_t* sess);
+
+/* Stops the channel and masks its interrupt */
+void xls_dma_session_close(xls_dma_session_t* sess);
+
+#endif /* __XLS_DMA_SESSION_H__ */
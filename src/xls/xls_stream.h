@@ -21,6 +21,9 @@
 
 #include <stdint.h>
 
+#include "common/mmio.h"
+#include "common/trace.h"
+
 /* XLS STREAM CONTROL REGISTER */
 
 #define TOKENCAT(x, y) x##y
@@ -50,17 +53,24 @@ typedef struct __attribute__((packed, aligned(8))) xls_stream {
 #define XLS_SCTRL_ERRXFER 0x08
 
 static inline int xls_is_ready(const xls_stream_t* stream) {
-  return stream->s_ctrl & XLS_SCTRL_RDY;
+  return MMIO_READ(MMIO_DEV_XLS, stream->s_ctrl) & XLS_SCTRL_RDY;
 }
 
+/* Identifies a stream in trace events */
+#define XLS_STREAM_TRACE_ID(stream) ((((uintptr_t)(stream)) >> 10) & 0xff)
+
 static inline void xls_poll_ready(const xls_stream_t* stream) {
+  if (xls_is_ready(stream)) return;
+
+  TRACE_EVENT(TRACE_STREAM_WAIT_BEGIN, XLS_STREAM_TRACE_ID(stream), 0);
   while (!xls_is_ready(stream))
     ;
+  TRACE_EVENT(TRACE_STREAM_WAIT_END, XLS_STREAM_TRACE_ID(stream), 0);
 }
 
 static inline void xls_poll_and_transfer(xls_stream_t* stream) {
   xls_poll_ready(stream);
-  stream->s_ctrl |= XLS_SCTRL_DOXFER;
+  MMIO_SET(MMIO_DEV_XLS, stream->s_ctrl, XLS_SCTRL_DOXFER);
 }
 
 #endif /* __XLS_STREAM_H__ */